@@ -0,0 +1,269 @@
+#include "ArcKernel.h"
+
+#include "CpuFeatures.h"
+#include <cmath>
+#include <stdexcept>
+
+#if defined(DXF2JEO_X86_64)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+    void evaluateScalar(ArcBlock& block, std::uint64_t i)
+    {
+        const auto dist1 = std::hypot(block.firstDx[i], block.firstDy[i]);
+        const auto dist2 = std::hypot(block.lastDx[i], block.lastDy[i]);
+        block.radius[i]  = (dist1 + dist2) / 2.;
+        block.theta1[i]  = std::atan2(block.firstDy[i], block.firstDx[i]);
+        block.theta2[i]  = std::atan2(block.lastDy[i], block.lastDx[i]);
+    }
+
+    void evaluateScalar(ArcBlock& block, std::uint64_t begin, std::uint64_t end)
+    {
+        for (auto i = begin; i < end; ++i)
+            evaluateScalar(block, i);
+    }
+
+    // Evaluates the arcs whose lanes are not set in validLanes with the scalar kernel
+    void evaluateScalar(ArcBlock& block, std::uint64_t begin, std::uint64_t laneCount, int validLanes)
+    {
+        for (std::uint64_t lane = 0; lane < laneCount; ++lane)
+            if ((validLanes & (1 << lane)) == 0)
+                evaluateScalar(block, begin + lane);
+    }
+
+#if defined(DXF2JEO_X86_64)
+
+    constexpr auto PI                  = 3.14159265358979323846;
+    constexpr auto PI_2                = 1.57079632679489661923;
+    constexpr auto PI_4                = 0.78539816339744830962;
+    constexpr auto TAN_3PI_8           = 2.41421356237309504880;
+    constexpr auto REDUCTION_THRESHOLD = 0.66;
+    constexpr auto MORE_BITS           = 6.123233995736765886130e-17; // pi / 2 minus PI_2
+
+    // atan(x) = x + x^3 P(x^2) / Q(x^2) on [-0.66, 0.66], Q being monic
+    constexpr auto P0 = -8.750608600031904122785e-1;
+    constexpr auto P1 = -1.615753718733365076637e1;
+    constexpr auto P2 = -7.500855792314704667340e1;
+    constexpr auto P3 = -1.228866684490136173410e2;
+    constexpr auto P4 = -6.485021904942025371773e1;
+    constexpr auto Q0 = 2.485846490142306297962e1;
+    constexpr auto Q1 = 1.650270098316988542046e2;
+    constexpr auto Q2 = 4.328810604912902668951e2;
+    constexpr auto Q3 = 4.853903996359136964868e2;
+    constexpr auto Q4 = 1.945506571482613964425e2;
+
+    // Squares of offsets within these bounds neither overflow nor underflow
+    constexpr auto MIN_OFFSET = 1e-150;
+    constexpr auto MAX_OFFSET = 1e150;
+
+    __m128d selectSse2(__m128d mask, __m128d a, __m128d b)
+    { //
+        return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+    }
+
+    // atan(y / x) with |y / x| reduced to at most 0.66, then moved to the quadrant of (x, y)
+    __m128d atan2Sse2(__m128d y, __m128d x)
+    {
+        const auto signMask = _mm_set1_pd(-0.);
+        const auto one      = _mm_set1_pd(1.);
+        const auto ratio    = _mm_div_pd(y, x);
+        const auto sign     = _mm_and_pd(ratio, signMask);
+        const auto a        = _mm_andnot_pd(signMask, ratio);
+
+        const auto large    = _mm_cmpgt_pd(a, _mm_set1_pd(TAN_3PI_8));
+        const auto medium   = _mm_andnot_pd(large, _mm_cmpgt_pd(a, _mm_set1_pd(REDUCTION_THRESHOLD)));
+        const auto reduced  = _mm_div_pd(_mm_sub_pd(a, one), _mm_add_pd(a, one));
+        const auto t        = selectSse2(large, _mm_div_pd(_mm_set1_pd(-1.), a), selectSse2(medium, reduced, a));
+        const auto offset   = selectSse2(large, _mm_set1_pd(PI_2), _mm_and_pd(medium, _mm_set1_pd(PI_4)));
+        const auto moreBits = selectSse2(large, _mm_set1_pd(MORE_BITS), _mm_and_pd(medium, _mm_set1_pd(MORE_BITS / 2)));
+
+        const auto z = _mm_mul_pd(t, t);
+        auto       p = _mm_set1_pd(P0);
+        p            = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(P1));
+        p            = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(P2));
+        p            = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(P3));
+        p            = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(P4));
+        auto q       = _mm_add_pd(z, _mm_set1_pd(Q0));
+        q            = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(Q1));
+        q            = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(Q2));
+        q            = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(Q3));
+        q            = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(Q4));
+
+        auto theta = _mm_div_pd(_mm_mul_pd(z, p), q);
+        theta      = _mm_add_pd(_mm_mul_pd(t, theta), t);
+        theta      = _mm_add_pd(offset, _mm_add_pd(theta, moreBits));
+        theta      = _mm_xor_pd(theta, sign);
+
+        // x of negative sign, -0 included, turns the angle by pi, in the direction given by the sign of y as std::atan2 does for null y
+        const auto negative = _mm_cmplt_pd(_mm_or_pd(_mm_and_pd(x, signMask), one), _mm_setzero_pd());
+        const auto halfTurn = _mm_or_pd(_mm_set1_pd(PI), _mm_and_pd(y, signMask));
+        return selectSse2(negative, _mm_add_pd(theta, halfTurn), theta);
+    }
+
+    __m128d inRangeSse2(__m128d dx, __m128d dy)
+    {
+        const auto signMask  = _mm_set1_pd(-0.);
+        const auto absDx     = _mm_andnot_pd(signMask, dx);
+        const auto absDy     = _mm_andnot_pd(signMask, dy);
+        const auto maxOffset = _mm_set1_pd(MAX_OFFSET);
+        const auto minOffset = _mm_set1_pd(MIN_OFFSET);
+        const auto notLarge  = _mm_and_pd(_mm_cmple_pd(absDx, maxOffset), _mm_cmple_pd(absDy, maxOffset));
+        return _mm_and_pd(notLarge, _mm_or_pd(_mm_cmpge_pd(absDx, minOffset), _mm_cmpge_pd(absDy, minOffset)));
+    }
+
+    // SSE2 is part of x86-64, this kernel needs no runtime check
+    void evaluateSse2(ArcBlock& block)
+    {
+        const auto half = _mm_set1_pd(0.5);
+
+        auto i = std::uint64_t{0};
+        for (; i + 2 <= block.size; i += 2) {
+            const auto firstDx = _mm_loadu_pd(block.firstDx.data() + i);
+            const auto firstDy = _mm_loadu_pd(block.firstDy.data() + i);
+            const auto lastDx  = _mm_loadu_pd(block.lastDx.data() + i);
+            const auto lastDy  = _mm_loadu_pd(block.lastDy.data() + i);
+            const auto dist1   = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(firstDx, firstDx), _mm_mul_pd(firstDy, firstDy)));
+            const auto dist2   = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(lastDx, lastDx), _mm_mul_pd(lastDy, lastDy)));
+            _mm_storeu_pd(block.radius.data() + i, _mm_mul_pd(_mm_add_pd(dist1, dist2), half));
+            _mm_storeu_pd(block.theta1.data() + i, atan2Sse2(firstDy, firstDx));
+            _mm_storeu_pd(block.theta2.data() + i, atan2Sse2(lastDy, lastDx));
+
+            const auto validLanes = _mm_movemask_pd(_mm_and_pd(inRangeSse2(firstDx, firstDy), inRangeSse2(lastDx, lastDy)));
+            if (validLanes != 0b11)
+                evaluateScalar(block, i, 2, validLanes);
+        }
+        evaluateScalar(block, i, block.size);
+    }
+
+    DXF2JEO_TARGET_AVX2 __m256d selectAvx2(__m256d mask, __m256d a, __m256d b)
+    { //
+        return _mm256_blendv_pd(b, a, mask);
+    }
+
+    DXF2JEO_TARGET_AVX2 __m256d atan2Avx2(__m256d y, __m256d x)
+    {
+        const auto signMask = _mm256_set1_pd(-0.);
+        const auto one      = _mm256_set1_pd(1.);
+        const auto ratio    = _mm256_div_pd(y, x);
+        const auto sign     = _mm256_and_pd(ratio, signMask);
+        const auto a        = _mm256_andnot_pd(signMask, ratio);
+
+        const auto large    = _mm256_cmp_pd(a, _mm256_set1_pd(TAN_3PI_8), _CMP_GT_OQ);
+        const auto medium   = _mm256_andnot_pd(large, _mm256_cmp_pd(a, _mm256_set1_pd(REDUCTION_THRESHOLD), _CMP_GT_OQ));
+        const auto reduced  = _mm256_div_pd(_mm256_sub_pd(a, one), _mm256_add_pd(a, one));
+        const auto t        = selectAvx2(large, _mm256_div_pd(_mm256_set1_pd(-1.), a), selectAvx2(medium, reduced, a));
+        const auto offset   = selectAvx2(large, _mm256_set1_pd(PI_2), _mm256_and_pd(medium, _mm256_set1_pd(PI_4)));
+        const auto moreBits = selectAvx2(large, _mm256_set1_pd(MORE_BITS), _mm256_and_pd(medium, _mm256_set1_pd(MORE_BITS / 2)));
+
+        const auto z = _mm256_mul_pd(t, t);
+        auto       p = _mm256_set1_pd(P0);
+        p            = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(P1));
+        p            = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(P2));
+        p            = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(P3));
+        p            = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(P4));
+        auto q       = _mm256_add_pd(z, _mm256_set1_pd(Q0));
+        q            = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(Q1));
+        q            = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(Q2));
+        q            = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(Q3));
+        q            = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(Q4));
+
+        auto theta = _mm256_div_pd(_mm256_mul_pd(z, p), q);
+        theta      = _mm256_add_pd(_mm256_mul_pd(t, theta), t);
+        theta      = _mm256_add_pd(offset, _mm256_add_pd(theta, moreBits));
+        theta      = _mm256_xor_pd(theta, sign);
+
+        const auto negative = _mm256_cmp_pd(_mm256_or_pd(_mm256_and_pd(x, signMask), one), _mm256_setzero_pd(), _CMP_LT_OQ);
+        const auto halfTurn = _mm256_or_pd(_mm256_set1_pd(PI), _mm256_and_pd(y, signMask));
+        return selectAvx2(negative, _mm256_add_pd(theta, halfTurn), theta);
+    }
+
+    DXF2JEO_TARGET_AVX2 __m256d inRangeAvx2(__m256d dx, __m256d dy)
+    {
+        const auto signMask  = _mm256_set1_pd(-0.);
+        const auto absDx     = _mm256_andnot_pd(signMask, dx);
+        const auto absDy     = _mm256_andnot_pd(signMask, dy);
+        const auto maxOffset = _mm256_set1_pd(MAX_OFFSET);
+        const auto minOffset = _mm256_set1_pd(MIN_OFFSET);
+        const auto notLarge  = _mm256_and_pd(_mm256_cmp_pd(absDx, maxOffset, _CMP_LE_OQ), _mm256_cmp_pd(absDy, maxOffset, _CMP_LE_OQ));
+        return _mm256_and_pd(notLarge, _mm256_or_pd(_mm256_cmp_pd(absDx, minOffset, _CMP_GE_OQ), _mm256_cmp_pd(absDy, minOffset, _CMP_GE_OQ)));
+    }
+
+    DXF2JEO_TARGET_AVX2 void evaluateAvx2(ArcBlock& block)
+    {
+        const auto half = _mm256_set1_pd(0.5);
+
+        auto i = std::uint64_t{0};
+        for (; i + 4 <= block.size; i += 4) {
+            const auto firstDx = _mm256_loadu_pd(block.firstDx.data() + i);
+            const auto firstDy = _mm256_loadu_pd(block.firstDy.data() + i);
+            const auto lastDx  = _mm256_loadu_pd(block.lastDx.data() + i);
+            const auto lastDy  = _mm256_loadu_pd(block.lastDy.data() + i);
+            const auto dist1   = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(firstDx, firstDx), _mm256_mul_pd(firstDy, firstDy)));
+            const auto dist2   = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(lastDx, lastDx), _mm256_mul_pd(lastDy, lastDy)));
+            _mm256_storeu_pd(block.radius.data() + i, _mm256_mul_pd(_mm256_add_pd(dist1, dist2), half));
+            _mm256_storeu_pd(block.theta1.data() + i, atan2Avx2(firstDy, firstDx));
+            _mm256_storeu_pd(block.theta2.data() + i, atan2Avx2(lastDy, lastDx));
+
+            const auto validLanes = _mm256_movemask_pd(_mm256_and_pd(inRangeAvx2(firstDx, firstDy), inRangeAvx2(lastDx, lastDy)));
+            if (validLanes != 0b1111) {
+                _mm256_zeroupper();
+                evaluateScalar(block, i, 4, validLanes);
+            }
+        }
+
+        // The compiler does not always clear the upper halves of the ymm registers on its own, the SSE code running next would then be slowed down
+        _mm256_zeroupper();
+        evaluateScalar(block, i, block.size);
+    }
+
+#endif
+}
+
+bool isSupported(ArcKernel kernel)
+{
+    switch (kernel) {
+    case ArcKernel::Scalar:
+        return true;
+#if defined(DXF2JEO_X86_64)
+    case ArcKernel::Sse2:
+        return true;
+    case ArcKernel::Avx2:
+        return hasAvx2();
+#endif
+    default:
+        return false;
+    }
+}
+
+ArcKernel getBestArcKernel()
+{
+    static const auto kernel = []() {
+        for (const auto kernel : {ArcKernel::Avx2, ArcKernel::Sse2})
+            if (isSupported(kernel))
+                return kernel;
+        return ArcKernel::Scalar;
+    }();
+    return kernel;
+}
+
+void evaluateArcs(ArcKernel kernel, ArcBlock& block)
+{
+    if (block.size > ARC_BLOCK_SIZE)
+        throw std::runtime_error{"too many arcs"};
+
+    switch (kernel) {
+#if defined(DXF2JEO_X86_64)
+    case ArcKernel::Sse2:
+        evaluateSse2(block);
+        break;
+    case ArcKernel::Avx2:
+        evaluateAvx2(block);
+        break;
+#endif
+    default:
+        evaluateScalar(block, 0, block.size);
+        break;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Vectorised evaluation of the radius and end angles of blocks of arcs, from the offsets of their first and last points to their center.
+// The scalar kernel calls std::hypot and std::atan2, as arcs used to be converted one at a time. Vector kernels compute lengths as square
+// roots of sums of squares and angles with the rational arc tangent approximation of Cephes, both within a few ulps of the scalar kernel.
+// Offsets whose squares could overflow or underflow, null, infinite or NaN ones, are left to the scalar kernel.
+
+enum class ArcKernel
+{
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+constexpr auto ARC_BLOCK_SIZE = std::uint64_t{64};
+
+struct ArcBlock
+{
+    std::uint64_t size = 0; // Arcs in the block, up to ARC_BLOCK_SIZE
+
+    // Offsets of the first and last points of arcs from their center
+    std::array<double, ARC_BLOCK_SIZE> firstDx;
+    std::array<double, ARC_BLOCK_SIZE> firstDy;
+    std::array<double, ARC_BLOCK_SIZE> lastDx;
+    std::array<double, ARC_BLOCK_SIZE> lastDy;
+
+    // Mean distance of the first and last points to the center, angles of the first and last points in [-pi, pi]
+    std::array<double, ARC_BLOCK_SIZE> radius;
+    std::array<double, ARC_BLOCK_SIZE> theta1;
+    std::array<double, ARC_BLOCK_SIZE> theta2;
+};
+
+bool isSupported(ArcKernel kernel);
+
+// Fastest kernel supported by the processor, chosen once
+ArcKernel getBestArcKernel();
+
+// Sets the radius and angles of the first block.size arcs from their offsets
+void evaluateArcs(ArcKernel kernel, ArcBlock& block);
\ No newline at end of file
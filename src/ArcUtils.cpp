@@ -9,7 +9,9 @@ namespace {
 
     double inRange_0_2PI(double theta)
     {
-        theta = std::fmod(theta, 2 * PI);
+        // std::fmod returns theta itself within (-2PI, 2PI), where the angles of arcs and their differences already are
+        if (std::fabs(theta) >= 2 * PI)
+            theta = std::fmod(theta, 2 * PI);
         if (theta < 0)
             theta += 2 * PI;
         return theta;
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+// Non-owning view over contiguous constant elements
+template<typename T>
+class ArrayView
+{
+  public:
+    ArrayView() = default;
+    ArrayView(const T* data, std::size_t size) : data_{data}, size_{size} {}
+    ArrayView(const std::vector<T>& values) : data_{values.data()}, size_{values.size()} {}
+
+    const T*    data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool        empty() const { return size_ == 0; }
+
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+
+    const T& operator[](std::size_t i) const { return data_[i]; }
+
+    const T& at(std::size_t i) const
+    {
+        if (i >= size_)
+            throw std::out_of_range{"array view index out of range"};
+        return data_[i];
+    }
+
+  private:
+    const T*    data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+template<typename T> bool operator==(const ArrayView<T>& view1, const ArrayView<T>& view2)
+{
+    return std::equal(view1.begin(), view1.end(), view2.begin(), view2.end());
+}
+
+template<typename T> bool operator!=(const ArrayView<T>& view1, const ArrayView<T>& view2) { return !(view1 == view2); }
\ No newline at end of file
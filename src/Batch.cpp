@@ -0,0 +1,107 @@
+#include "Batch.h"
+
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cctype>
+#include <fmt/format.h>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+    std::string toLower(std::string text)
+    {
+        std::transform(text.begin(), text.end(), text.begin(), [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+        return text;
+    }
+}
+
+std::vector<std::filesystem::path> readBatchManifest(const std::filesystem::path& manifestPath)
+{
+    auto in = std::ifstream{manifestPath};
+    if (!in.is_open())
+        throw std::runtime_error{fmt::format("unable to read file {}", manifestPath.string())};
+
+    auto paths = std::vector<std::filesystem::path>{};
+    auto line  = std::string{};
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (!line.empty())
+            paths.emplace_back(line);
+    }
+    return paths;
+}
+
+std::vector<std::filesystem::path> collectBatchInputs(const std::vector<std::filesystem::path>& inputPaths, const std::vector<std::string>& inputExtensions)
+{
+    const auto hasInputExtension = [&](const std::filesystem::path& path) {
+        const auto extension = toLower(path.extension().string());
+        return std::any_of(inputExtensions.begin(), inputExtensions.end(), [&](const std::string& inputExtension) {
+            return extension == toLower(inputExtension);
+        });
+    };
+
+    auto paths = std::vector<std::filesystem::path>{};
+    for (const auto& inputPath : inputPaths) {
+        if (!std::filesystem::is_directory(inputPath)) {
+            paths.push_back(inputPath);
+            continue;
+        }
+
+        auto directoryPaths = std::vector<std::filesystem::path>{};
+        for (const auto& entry : std::filesystem::directory_iterator{inputPath})
+            if (entry.is_regular_file() && hasInputExtension(entry.path()))
+                directoryPaths.push_back(entry.path());
+        std::sort(directoryPaths.begin(), directoryPaths.end());
+        paths.insert(paths.end(), directoryPaths.begin(), directoryPaths.end());
+    }
+    return paths;
+}
+
+std::vector<BatchItem> makeBatchItems(const std::vector<std::filesystem::path>& inputPaths, const std::filesystem::path& outputDir, std::string_view extension)
+{
+    auto items       = std::vector<BatchItem>{};
+    auto outputIndex = std::unordered_map<std::string, std::size_t>{};
+    for (const auto& inputPath : inputPaths) {
+        auto outputPath = outputDir / inputPath.stem();
+        outputPath += std::string{extension};
+
+        const auto [it, inserted] = outputIndex.try_emplace(outputPath.string(), items.size());
+        if (!inserted) {
+            const auto& otherInputPath = items[it->second].inputPath;
+            throw std::runtime_error{fmt::format("{} and {} have the same output file {}", otherInputPath.string(), inputPath.string(), outputPath.string())};
+        }
+        items.push_back(BatchItem{inputPath, std::move(outputPath)});
+    }
+    return items;
+}
+
+std::vector<BatchFailure> runBatch(const std::vector<BatchItem>& items, std::uint64_t jobCount, const std::function<void(const BatchItem&)>& convert)
+{
+    auto messages = std::vector<std::optional<std::string>>(items.size());
+    {
+        auto threadPool = ThreadPool{std::min<std::uint64_t>(jobCount, std::max<std::size_t>(items.size(), 1))};
+        for (std::size_t i = 0, n = items.size(); i < n; ++i) {
+            threadPool.submit([&, i]() {
+                try {
+                    convert(items[i]);
+                }
+                catch (const std::exception& e) {
+                    messages[i] = e.what();
+                }
+                catch (...) {
+                    messages[i] = "unknown exception";
+                }
+            });
+        }
+        threadPool.wait();
+    }
+
+    auto failures = std::vector<BatchFailure>{};
+    for (std::size_t i = 0, n = items.size(); i < n; ++i)
+        if (messages[i])
+            failures.push_back(BatchFailure{items[i].inputPath, std::move(*messages[i])});
+    return failures;
+}
\ No newline at end of file
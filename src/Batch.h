@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct BatchItem
+{
+    std::filesystem::path inputPath;
+    std::filesystem::path outputPath;
+};
+
+struct BatchFailure
+{
+    std::filesystem::path inputPath;
+    std::string           message;
+};
+
+// Paths listed in a manifest file, one per line, blank lines being ignored
+std::vector<std::filesystem::path> readBatchManifest(const std::filesystem::path& manifestPath);
+
+// Regular files are kept as they are, directories contribute the files they directly contain having one of inputExtensions
+std::vector<std::filesystem::path> collectBatchInputs(const std::vector<std::filesystem::path>& inputPaths, const std::vector<std::string>& inputExtensions);
+
+// Pairs every input with outputDir/<input stem><extension>, two inputs sharing the same output being an error
+std::vector<BatchItem> makeBatchItems(const std::vector<std::filesystem::path>& inputPaths, const std::filesystem::path& outputDir, std::string_view extension);
+
+// Runs convert on every item on jobCount threads. An item failing does not stop the other ones, failures are returned in item order.
+std::vector<BatchFailure> runBatch(const std::vector<BatchItem>& items, std::uint64_t jobCount, const std::function<void(const BatchItem&)>& convert);
\ No newline at end of file
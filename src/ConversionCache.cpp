@@ -0,0 +1,200 @@
+#include "ConversionCache.h"
+
+#include "InputFile.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fmt/format.h>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+namespace {
+    constexpr auto PRIME64_1 = std::uint64_t{0x9E3779B185EBCA87};
+    constexpr auto PRIME64_2 = std::uint64_t{0xC2B2AE3D27D4EB4F};
+    constexpr auto PRIME64_3 = std::uint64_t{0x165667B19E3779F9};
+    constexpr auto PRIME64_4 = std::uint64_t{0x85EBCA77C2B2AE63};
+    constexpr auto PRIME64_5 = std::uint64_t{0x27D4EB2F165667C5};
+
+    constexpr auto TEMPORARY_SUFFIX = std::string_view{".tmp"};
+
+    std::uint64_t rotateLeft(std::uint64_t value, int count) { return (value << count) | (value >> (64 - count)); }
+
+    // Little-endian reads, as specified by XXH64
+    std::uint64_t read64(const char* data)
+    {
+        auto bytes = std::array<unsigned char, 8>{};
+        std::memcpy(bytes.data(), data, bytes.size());
+        auto value = std::uint64_t{0};
+        for (auto i = 8; i-- > 0;)
+            value = (value << 8) | bytes[i];
+        return value;
+    }
+
+    std::uint64_t read32(const char* data)
+    {
+        auto bytes = std::array<unsigned char, 4>{};
+        std::memcpy(bytes.data(), data, bytes.size());
+        return std::uint64_t{bytes[0]} | std::uint64_t{bytes[1]} << 8 | std::uint64_t{bytes[2]} << 16 | std::uint64_t{bytes[3]} << 24;
+    }
+
+    std::uint64_t round(std::uint64_t accumulator, std::uint64_t input) { return rotateLeft(accumulator + input * PRIME64_2, 31) * PRIME64_1; }
+    std::uint64_t mergeRound(std::uint64_t accumulator, std::uint64_t value) { return (accumulator ^ round(0, value)) * PRIME64_1 + PRIME64_4; }
+
+    bool isTemporary(const std::filesystem::path& path) { return path.filename().string().find(TEMPORARY_SUFFIX) != std::string::npos; }
+
+    struct CacheEntry
+    {
+        std::filesystem::path           path;
+        std::filesystem::file_time_type time;
+        std::uint64_t                   size;
+    };
+
+    // Entries of the cache directory, without the temporary files of entries being stored
+    std::vector<CacheEntry> listEntries(const std::filesystem::path& directory)
+    {
+        auto entries = std::vector<CacheEntry>{};
+        auto error   = std::error_code{};
+        for (const auto& entry : std::filesystem::directory_iterator{directory, error}) {
+            if (!entry.is_regular_file(error) || isTemporary(entry.path()))
+                continue;
+            const auto time = entry.last_write_time(error);
+            const auto size = entry.file_size(error);
+            if (error)
+                continue;
+            entries.push_back(CacheEntry{entry.path(), time, size});
+        }
+        return entries;
+    }
+
+    std::uint64_t getTotalSize(const std::vector<CacheEntry>& entries)
+    {
+        auto totalSize = std::uint64_t{0};
+        for (const auto& entry : entries)
+            totalSize += entry.size;
+        return totalSize;
+    }
+}
+
+std::uint64_t xxHash64(std::string_view bytes, std::uint64_t seed)
+{
+    auto       data = bytes.data();
+    const auto end  = data + bytes.size();
+
+    auto hash = std::uint64_t{0};
+    if (bytes.size() >= 32) {
+        auto v1 = seed + PRIME64_1 + PRIME64_2;
+        auto v2 = seed + PRIME64_2;
+        auto v3 = seed;
+        auto v4 = seed - PRIME64_1;
+        for (; end - data >= 32; data += 32) {
+            v1 = round(v1, read64(data));
+            v2 = round(v2, read64(data + 8));
+            v3 = round(v3, read64(data + 16));
+            v4 = round(v4, read64(data + 24));
+        }
+        hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+        hash = mergeRound(hash, v1);
+        hash = mergeRound(hash, v2);
+        hash = mergeRound(hash, v3);
+        hash = mergeRound(hash, v4);
+    }
+    else {
+        hash = seed + PRIME64_5;
+    }
+    hash += bytes.size();
+
+    for (; end - data >= 8; data += 8)
+        hash = rotateLeft(hash ^ round(0, read64(data)), 27) * PRIME64_1 + PRIME64_4;
+    if (end - data >= 4) {
+        hash = rotateLeft(hash ^ (read32(data) * PRIME64_1), 23) * PRIME64_2 + PRIME64_3;
+        data += 4;
+    }
+    for (; data != end; ++data)
+        hash = rotateLeft(hash ^ (static_cast<unsigned char>(*data) * PRIME64_5), 11) * PRIME64_1;
+
+    hash ^= hash >> 33;
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+ConversionCache::ConversionCache(std::filesystem::path directory, std::uint64_t maxSize, std::string context)
+    : directory_{std::move(directory)}, maxSize_{maxSize}, context_{std::move(context)}, contextHash_{xxHash64(context_)}
+{
+    std::filesystem::create_directories(directory_);
+    size_ = getTotalSize(listEntries(directory_));
+}
+
+bool ConversionCache::convert(const std::filesystem::path& inputPath, const std::filesystem::path& outputPath, const ConversionFunction& convert)
+{
+    auto key = std::string{};
+    {
+        // The size makes a collision even less likely, two inputs having to share both
+        const auto inputFile = InputFile{inputPath, InputFileAccess::Sequential};
+        const auto contents  = inputFile.contents();
+        const auto seed      = xxHash64(outputPath.extension().string(), contextHash_);
+        key                  = fmt::format("{:016x}-{}{}", xxHash64(contents, seed), contents.size(), outputPath.extension().string());
+    }
+    const auto entryPath = directory_ / key;
+
+    auto error = std::error_code{};
+    // Copies rather than hard links, a later overwrite of the output must not alter the entry
+    if (std::filesystem::copy_file(entryPath, outputPath, std::filesystem::copy_options::overwrite_existing, error)) {
+        // Marks the entry as recently used, failing when another process has just evicted it is harmless
+        std::filesystem::last_write_time(entryPath, std::filesystem::file_time_type::clock::now(), error);
+        ++hits_;
+        return true;
+    }
+
+    ++misses_;
+    convert(inputPath, outputPath);
+
+    // Written aside then renamed, so that other processes never see a partial entry
+    static const auto processTag    = std::random_device{}();
+    static auto       counter       = std::atomic<std::uint64_t>{0};
+    const auto        temporaryPath = directory_ / fmt::format("{}{}-{:08x}-{}", key, TEMPORARY_SUFFIX, processTag, counter++);
+    const auto        entrySize     = std::filesystem::file_size(outputPath);
+    std::filesystem::copy_file(outputPath, temporaryPath, std::filesystem::copy_options::overwrite_existing);
+    std::filesystem::rename(temporaryPath, entryPath, error);
+    if (error) {
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+
+    const auto lock = std::lock_guard{mutex_};
+    size_ += entrySize;
+    if (size_ > maxSize_)
+        evict();
+    return false;
+}
+
+ConversionCacheStats ConversionCache::stats() const
+{
+    auto stats      = ConversionCacheStats{};
+    stats.hits      = hits_;
+    stats.misses    = misses_;
+    stats.evictions = evictions_;
+    return stats;
+}
+
+void ConversionCache::evict()
+{
+    auto entries = listEntries(directory_);
+    size_        = getTotalSize(entries);
+    if (size_ <= maxSize_)
+        return;
+
+    auto error = std::error_code{};
+    std::sort(entries.begin(), entries.end(), [](const CacheEntry& entry1, const CacheEntry& entry2) { return entry1.time < entry2.time; });
+    for (const auto& entry : entries) {
+        if (size_ <= maxSize_)
+            break;
+        if (std::filesystem::remove(entry.path, error))
+            ++evictions_;
+        size_ -= entry.size;
+    }
+}
\ No newline at end of file
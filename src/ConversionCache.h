@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ConversionFunction.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+struct ConversionCacheStats
+{
+    std::uint64_t hits      = 0;
+    std::uint64_t misses    = 0;
+    std::uint64_t evictions = 0;
+};
+
+// On-disk cache of conversion outputs, keyed by a hash of the input bytes, the context (converter version and
+// options) and the output extension. Entries are files named after their key, the least recently used ones,
+// according to their modification time, being evicted once the cache grows over maxSize bytes. Several
+// processes may share the same directory. The size of the cache is scanned once, then estimated from the entries
+// stored by this instance, the directory being only scanned again when the estimate goes over maxSize.
+class ConversionCache
+{
+  public:
+    ConversionCache(std::filesystem::path directory, std::uint64_t maxSize, std::string context);
+
+    // Writes outputPath from the cache, or runs convert and stores its output. Returns whether it was a hit.
+    bool convert(const std::filesystem::path& inputPath, const std::filesystem::path& outputPath, const ConversionFunction& convert);
+
+    ConversionCacheStats stats() const;
+
+  private:
+    // Rescans the directory, then evicts entries until the cache fits in maxSize_, mutex_ being held
+    void evict();
+
+    std::filesystem::path      directory_;
+    std::uint64_t              maxSize_;
+    std::string                context_;
+    std::uint64_t              contextHash_;
+    std::mutex                 mutex_;
+    std::uint64_t              size_ = 0; // Estimated size of the entries, guarded by mutex_
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+    std::atomic<std::uint64_t> evictions_{0};
+};
+
+// XXH64 hash of bytes
+std::uint64_t xxHash64(std::string_view bytes, std::uint64_t seed = 0);
\ No newline at end of file
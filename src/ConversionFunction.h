@@ -0,0 +1,7 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+
+// Converts the file at inputPath into outputPath, throwing on failure
+using ConversionFunction = std::function<void(const std::filesystem::path& inputPath, const std::filesystem::path& outputPath)>;
\ No newline at end of file
@@ -0,0 +1,353 @@
+#include "ConversionServer.h"
+
+#include "InputFile.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <fmt/format.h>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+void runConversionServer(const std::filesystem::path&, std::uint64_t, const ConversionFunction&)
+{
+    throw std::runtime_error{"conversion server is only supported on POSIX systems"};
+}
+
+void requestConversion(const std::filesystem::path&, const std::filesystem::path&, const std::filesystem::path&)
+{
+    throw std::runtime_error{"conversion server is only supported on POSIX systems"};
+}
+
+void requestInlineConversion(const std::filesystem::path&, const std::filesystem::path&, const std::filesystem::path&)
+{
+    throw std::runtime_error{"conversion server is only supported on POSIX systems"};
+}
+
+void requestServerStop(const std::filesystem::path&) { throw std::runtime_error{"conversion server is only supported on POSIX systems"}; }
+
+#else
+
+namespace {
+    constexpr auto POLL_TIMEOUT_MS  = 200;
+    constexpr auto READ_BUFFER_SIZE = std::size_t{64 * 1024};
+    constexpr auto MAX_LINE_SIZE    = std::size_t{64 * 1024};
+    constexpr auto RECEIVE_TIMEOUT  = timeval{60, 0};
+
+#if defined(MSG_NOSIGNAL)
+    constexpr auto SEND_FLAGS = MSG_NOSIGNAL;
+#else
+    constexpr auto SEND_FLAGS = 0;
+#endif
+
+    [[noreturn]] void throwSystemError(std::string_view what) { throw std::runtime_error{fmt::format("{}: {}", what, std::strerror(errno))}; }
+
+    class Socket
+    {
+      public:
+        Socket()
+        {
+            fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd_ < 0)
+                throwSystemError("unable to create socket");
+#if defined(SO_NOSIGPIPE)
+            const auto enabled = 1;
+            setsockopt(fd_, SOL_SOCKET, SO_NOSIGPIPE, &enabled, sizeof(enabled));
+#endif
+        }
+        explicit Socket(int fd) : fd_{fd} {}
+        ~Socket() { close(fd_); }
+
+        Socket(const Socket&)            = delete;
+        Socket& operator=(const Socket&) = delete;
+
+        int fd() const { return fd_; }
+
+      private:
+        int fd_ = -1;
+    };
+
+    // Buffered reads of lines and byte blocks from a socket
+    class SocketReader
+    {
+      public:
+        explicit SocketReader(const Socket& socket) : fd_{socket.fd()} {}
+
+        std::string readLine()
+        {
+            auto end = buffer_.find('\n');
+            while (end == std::string::npos) {
+                if (buffer_.size() > MAX_LINE_SIZE)
+                    throw std::runtime_error{"request line is too long"};
+                fill();
+                end = buffer_.find('\n');
+            }
+            auto line = buffer_.substr(0, end);
+            buffer_.erase(0, end + 1);
+            return line;
+        }
+
+        std::string readBytes(std::size_t size)
+        {
+            while (buffer_.size() < size)
+                fill();
+            auto bytes = buffer_.substr(0, size);
+            buffer_.erase(0, size);
+            return bytes;
+        }
+
+      private:
+        void fill()
+        {
+            char data[READ_BUFFER_SIZE];
+            while (true) {
+                const auto size = recv(fd_, data, sizeof(data), 0);
+                if (size > 0) {
+                    buffer_.append(data, static_cast<std::size_t>(size));
+                    return;
+                }
+                if (size == 0)
+                    throw std::runtime_error{"connection closed before the end of the message"};
+                if (errno != EINTR)
+                    throwSystemError("unable to read from socket");
+            }
+        }
+
+        int         fd_;
+        std::string buffer_;
+    };
+
+    void writeAll(const Socket& socket, std::string_view data)
+    {
+        while (!data.empty()) {
+            const auto size = send(socket.fd(), data.data(), data.size(), SEND_FLAGS);
+            if (size < 0) {
+                if (errno == EINTR)
+                    continue;
+                throwSystemError("unable to write to socket");
+            }
+            data.remove_prefix(static_cast<std::size_t>(size));
+        }
+    }
+
+    sockaddr_un toAddress(const std::filesystem::path& socketPath)
+    {
+        const auto path = socketPath.string();
+
+        auto address       = sockaddr_un{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+            throw std::runtime_error{fmt::format("socket path is too long: {}", path)};
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return address;
+    }
+
+    std::size_t parseSize(std::string_view text)
+    {
+        auto       size   = std::size_t{0};
+        const auto result = std::from_chars(text.data(), text.data() + text.size(), size);
+        if (result.ec != std::errc{} || result.ptr != text.data() + text.size())
+            throw std::runtime_error{fmt::format("invalid byte count: {}", text)};
+        return size;
+    }
+
+    // Extensions name temporary files, so they may not contain path separators
+    std::string checkExtension(std::string extension)
+    {
+        const auto isExtensionChar = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) != 0; };
+        if (extension.size() < 2 || extension[0] != '.' || !std::all_of(extension.begin() + 1, extension.end(), isExtensionChar))
+            throw std::runtime_error{fmt::format("invalid file extension: {}", extension)};
+        return extension;
+    }
+
+    std::string readFile(const std::filesystem::path& filePath)
+    {
+        const auto inputFile = InputFile{filePath, InputFileAccess::Sequential};
+        return std::string{inputFile.contents()};
+    }
+
+    void writeFile(const std::filesystem::path& filePath, std::string_view contents)
+    {
+        auto out = std::ofstream{filePath, std::ios::binary};
+        out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        out.flush();
+        if (!out)
+            throw std::runtime_error{fmt::format("unable to write file {}", filePath.string())};
+    }
+
+    // Uniquely named file in the temporary directory, removed on destruction
+    class TemporaryFile
+    {
+      public:
+        explicit TemporaryFile(std::string_view extension)
+        {
+            static auto counter = std::atomic<std::uint64_t>{0};
+            path_               = std::filesystem::temp_directory_path() / fmt::format("dxf2jeo-{}-{}{}", getpid(), counter++, extension);
+        }
+        ~TemporaryFile()
+        {
+            auto error = std::error_code{};
+            std::filesystem::remove(path_, error);
+        }
+
+        TemporaryFile(const TemporaryFile&)            = delete;
+        TemporaryFile& operator=(const TemporaryFile&) = delete;
+
+        const std::filesystem::path& path() const { return path_; }
+
+      private:
+        std::filesystem::path path_;
+    };
+
+    // Returns what follows the "ok" status line of the response
+    std::string handleRequest(SocketReader& reader, const ConversionFunction& convert, std::atomic<bool>& stopping)
+    {
+        const auto command = reader.readLine();
+        if (command == "convert") {
+            const auto inputPath  = std::filesystem::path{reader.readLine()};
+            const auto outputPath = std::filesystem::path{reader.readLine()};
+            convert(inputPath, outputPath);
+            return {};
+        }
+        if (command == "convert-inline") {
+            const auto inputFile  = TemporaryFile{checkExtension(reader.readLine())};
+            const auto outputFile = TemporaryFile{checkExtension(reader.readLine())};
+            const auto size       = parseSize(reader.readLine());
+            writeFile(inputFile.path(), reader.readBytes(size));
+            convert(inputFile.path(), outputFile.path());
+            const auto output = readFile(outputFile.path());
+            return fmt::format("{}\n", output.size()) + output;
+        }
+        if (command == "stop") {
+            stopping = true;
+            return {};
+        }
+        throw std::runtime_error{fmt::format("unknown request: {}", command)};
+    }
+
+    void serveConnection(const Socket& connection, const ConversionFunction& convert, std::atomic<bool>& stopping)
+    {
+        auto response = std::string{};
+        try {
+            auto reader = SocketReader{connection};
+            response    = "ok\n" + handleRequest(reader, convert, stopping);
+        }
+        catch (const std::exception& e) {
+            auto message = std::string{e.what()};
+            std::replace(message.begin(), message.end(), '\n', ' ');
+            response = fmt::format("error\n{}\n", message);
+        }
+
+        try {
+            writeAll(connection, response);
+        }
+        catch (const std::exception&) {
+            // The client went away, nothing left to tell it
+        }
+    }
+
+    // Sends request and checks the status of the response, the rest of which is left in reader
+    void sendRequest(const std::filesystem::path& socketPath, const Socket& connection, SocketReader& reader, std::string_view request)
+    {
+        const auto address = toAddress(socketPath);
+        if (connect(connection.fd(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+            throwSystemError(fmt::format("unable to connect to {}", socketPath.string()));
+
+        writeAll(connection, request);
+        const auto status = reader.readLine();
+        if (status == "error")
+            throw std::runtime_error{reader.readLine()};
+        if (status != "ok")
+            throw std::runtime_error{fmt::format("invalid server response: {}", status)};
+    }
+}
+
+void runConversionServer(const std::filesystem::path& socketPath, std::uint64_t jobCount, const ConversionFunction& convert)
+{
+    const auto address  = toAddress(socketPath);
+    const auto listener = Socket{};
+
+    // A socket left by a server which did not stop cleanly
+    if (std::filesystem::is_socket(socketPath))
+        std::filesystem::remove(socketPath);
+
+    if (bind(listener.fd(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+        throwSystemError(fmt::format("unable to bind {}", socketPath.string()));
+    if (listen(listener.fd(), SOMAXCONN) != 0)
+        throwSystemError(fmt::format("unable to listen on {}", socketPath.string()));
+
+    auto stopping = std::atomic<bool>{false};
+    {
+        auto threadPool = ThreadPool{jobCount};
+        while (!stopping) {
+            // Polled with a timeout so that a stop request handled by a worker is noticed
+            auto       pollFd = pollfd{listener.fd(), POLLIN, 0};
+            const auto ready  = poll(&pollFd, 1, POLL_TIMEOUT_MS);
+            if (ready < 0 && errno != EINTR)
+                throwSystemError("unable to wait for connections");
+            if (ready <= 0)
+                continue;
+
+            const auto fd = accept(listener.fd(), nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED)
+                    continue;
+                throwSystemError("unable to accept connection");
+            }
+
+            // A client that stops sending may not hold a worker forever
+            const auto connection = std::make_shared<Socket>(fd);
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &RECEIVE_TIMEOUT, sizeof(RECEIVE_TIMEOUT));
+            threadPool.submit([connection, &convert, &stopping]() { serveConnection(*connection, convert, stopping); });
+        }
+        threadPool.wait();
+    }
+    std::filesystem::remove(socketPath);
+}
+
+void requestConversion(const std::filesystem::path& socketPath, const std::filesystem::path& inputPath, const std::filesystem::path& outputPath)
+{
+    // The server does not share the working directory of the client
+    const auto request = fmt::format("convert\n{}\n{}\n", std::filesystem::absolute(inputPath).string(), std::filesystem::absolute(outputPath).string());
+
+    const auto connection = Socket{};
+    auto       reader     = SocketReader{connection};
+    sendRequest(socketPath, connection, reader, request);
+}
+
+void requestInlineConversion(const std::filesystem::path& socketPath, const std::filesystem::path& inputPath, const std::filesystem::path& outputPath)
+{
+    const auto input   = readFile(inputPath);
+    const auto request = fmt::format("convert-inline\n{}\n{}\n{}\n", inputPath.extension().string(), outputPath.extension().string(), input.size()) + input;
+
+    const auto connection = Socket{};
+    auto       reader     = SocketReader{connection};
+    sendRequest(socketPath, connection, reader, request);
+    const auto size = parseSize(reader.readLine());
+    writeFile(outputPath, reader.readBytes(size));
+}
+
+void requestServerStop(const std::filesystem::path& socketPath)
+{
+    const auto connection = Socket{};
+    auto       reader     = SocketReader{connection};
+    sendRequest(socketPath, connection, reader, "stop\n");
+}
+
+#endif
\ No newline at end of file
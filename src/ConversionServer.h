@@ -0,0 +1,22 @@
+#pragma once
+
+#include "ConversionFunction.h"
+#include <cstdint>
+#include <filesystem>
+
+// Local conversion server, keeping a process and its lazily built tables alive between conversions.
+//
+// Clients connect to a Unix domain socket and send one request per connection, made of lines:
+//   convert\n<input path>\n<output path>\n
+//   convert-inline\n<input extension>\n<output extension>\n<byte count>\n<input bytes>
+//   stop\n
+// The server answers "ok\n", followed by "<byte count>\n<output bytes>" for inline requests, or "error\n<message>\n".
+// Only available on POSIX systems.
+
+// Serves requests on socketPath with convert running on jobCount threads, until a stop request is received
+void runConversionServer(const std::filesystem::path& socketPath, std::uint64_t jobCount, const ConversionFunction& convert);
+
+// Client requests, throwing the message of the server when it fails
+void requestConversion(const std::filesystem::path& socketPath, const std::filesystem::path& inputPath, const std::filesystem::path& outputPath);
+void requestInlineConversion(const std::filesystem::path& socketPath, const std::filesystem::path& inputPath, const std::filesystem::path& outputPath);
+void requestServerStop(const std::filesystem::path& socketPath);
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "ConversionStats.h"
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <jsoncons/json.hpp>
+#include <sstream>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#if defined(_WIN32)
+
+double getProcessCpuTime()
+{
+    auto creationTime = FILETIME{};
+    auto exitTime     = FILETIME{};
+    auto kernelTime   = FILETIME{};
+    auto userTime     = FILETIME{};
+    if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+        return 0.;
+
+    // FILETIME counts 100 nanosecond intervals
+    const auto toSeconds = [](const FILETIME& time) { return ((std::uint64_t{time.dwHighDateTime} << 32) | time.dwLowDateTime) * 1e-7; };
+    return toSeconds(kernelTime) + toSeconds(userTime);
+}
+
+std::uint64_t getPeakRss()
+{
+    auto counters = PROCESS_MEMORY_COUNTERS{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.PeakWorkingSetSize;
+}
+
+#else
+
+double getProcessCpuTime()
+{
+    auto usage = rusage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0.;
+
+    const auto toSeconds = [](const timeval& time) { return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_usec) * 1e-6; };
+    return toSeconds(usage.ru_utime) + toSeconds(usage.ru_stime);
+}
+
+std::uint64_t getPeakRss()
+{
+    auto usage = rusage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+
+#if defined(__APPLE__)
+    return static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+    // Kilobytes on Linux
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+#endif
+
+void setCount(ConversionStats& stats, std::string_view name, std::uint64_t count)
+{
+    const auto it = std::find_if(stats.counts.begin(), stats.counts.end(), [&](const auto& nameCount) { return nameCount.first == name; });
+    if (it != stats.counts.end())
+        it->second = count;
+    else
+        stats.counts.emplace_back(std::string{name}, count);
+}
+
+std::string formatStatsText(const ConversionStats& stats)
+{
+    auto text = fmt::format("{:<12} {:>12} {:>12}\n", "stage", "wall (s)", "cpu (s)");
+    for (const auto& stage : stats.stages)
+        text += fmt::format("{:<12} {:>12.6f} {:>12.6f}\n", stage.name, stage.wallTime, stage.cpuTime);
+    for (const auto& [name, count] : stats.counts)
+        text += fmt::format("{:<12} {:>12}\n", name, count);
+    text += fmt::format("{:<12} {:>12}\n", "bytes in", stats.bytesIn);
+    text += fmt::format("{:<12} {:>12}\n", "bytes out", stats.bytesOut);
+    text += fmt::format("{:<12} {:>12}\n", "peak rss", stats.peakRss);
+    return text;
+}
+
+std::string formatStatsJson(const ConversionStats& stats)
+{
+    auto out     = std::ostringstream{};
+    auto encoder = jsoncons::json_stream_encoder{out, jsoncons::json_options{}};
+    encoder.begin_object();
+    encoder.key("stages");
+    encoder.begin_object();
+    for (const auto& stage : stats.stages) {
+        encoder.key(stage.name);
+        encoder.begin_object();
+        encoder.key("wallTime");
+        encoder.double_value(stage.wallTime);
+        encoder.key("cpuTime");
+        encoder.double_value(stage.cpuTime);
+        encoder.end_object();
+    }
+    encoder.end_object();
+    encoder.key("counts");
+    encoder.begin_object();
+    for (const auto& [name, count] : stats.counts) {
+        encoder.key(name);
+        encoder.uint64_value(count);
+    }
+    encoder.end_object();
+    encoder.key("bytesIn");
+    encoder.uint64_value(stats.bytesIn);
+    encoder.key("bytesOut");
+    encoder.uint64_value(stats.bytesOut);
+    encoder.key("peakRss");
+    encoder.uint64_value(stats.peakRss);
+    encoder.end_object();
+    encoder.flush();
+    return out.str() + '\n';
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+struct StageStats
+{
+    std::string name;
+    double      wallTime = 0.; // Seconds
+    double      cpuTime  = 0.; // Seconds spent by every thread of the process
+};
+
+// Measurements of a conversion, reported by the --stats option of the executables
+struct ConversionStats
+{
+    std::vector<StageStats>                            stages;
+    std::vector<std::pair<std::string, std::uint64_t>> counts;
+    std::uint64_t                                      bytesIn  = 0;
+    std::uint64_t                                      bytesOut = 0;
+    std::uint64_t                                      peakRss  = 0; // Bytes
+};
+
+// Processor time used by the process so far, in seconds
+double getProcessCpuTime();
+
+// Peak resident set size of the process so far, in bytes
+std::uint64_t getPeakRss();
+
+void setCount(ConversionStats& stats, std::string_view name, std::uint64_t count);
+
+// Runs function, adding its times to the stage of stats named name, stats being optional
+template<typename Function> auto measureStage(ConversionStats* stats, std::string_view name, Function&& function)
+{
+    if (stats == nullptr)
+        return function();
+
+    struct StageTimer
+    {
+        ~StageTimer()
+        {
+            const auto wallTime = std::chrono::duration<double>{std::chrono::steady_clock::now() - wallStart}.count();
+            const auto cpuTime  = getProcessCpuTime() - cpuStart;
+            stats->stages.push_back(StageStats{std::string{name}, wallTime, cpuTime});
+        }
+
+        ConversionStats*                      stats;
+        std::string_view                      name;
+        std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+        double                                cpuStart  = getProcessCpuTime();
+    };
+
+    const auto timer = StageTimer{stats, name};
+    return function();
+}
+
+std::string formatStatsText(const ConversionStats& stats);
+std::string formatStatsJson(const ConversionStats& stats);
\ No newline at end of file
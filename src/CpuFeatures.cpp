@@ -0,0 +1,42 @@
+#include "CpuFeatures.h"
+
+#include <array>
+
+#if defined(DXF2JEO_X86_64) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace {
+
+    bool detectAvx2()
+    {
+#if !defined(DXF2JEO_X86_64)
+        return false;
+#elif defined(_MSC_VER)
+        auto registers = std::array<int, 4>{};
+        __cpuid(registers.data(), 0);
+        if (registers[0] < 7)
+            return false;
+
+        // The processor must support AVX and the system must save the ymm registers
+        __cpuid(registers.data(), 1);
+        constexpr auto OSXSAVE = 1 << 27;
+        constexpr auto AVX     = 1 << 28;
+        if ((registers[2] & (OSXSAVE | AVX)) != (OSXSAVE | AVX) || (_xgetbv(0) & 6) != 6)
+            return false;
+
+        __cpuidex(registers.data(), 7, 0);
+        constexpr auto AVX2 = 1 << 5;
+        return (registers[1] & AVX2) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+}
+
+bool hasAvx2()
+{
+    static const auto avx2 = detectAvx2();
+    return avx2;
+}
\ No newline at end of file
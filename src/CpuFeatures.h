@@ -0,0 +1,18 @@
+#pragma once
+
+// Vector kernels are written for x86-64, where SSE2 is always available and AVX2 is checked at runtime
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define DXF2JEO_X86_64
+#endif
+
+// Functions using AVX2 intrinsics are compiled for AVX2 on their own, the rest of the program keeping the baseline target.
+// Only fma is left out, a fused multiply-add would round differently than the other kernels.
+#if defined(__GNUC__)
+#define DXF2JEO_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define DXF2JEO_TARGET_AVX2
+#endif
+
+// Whether the processor and the system support AVX2, checked once. Always false outside of x86-64.
+bool hasAvx2();
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "DistanceKernel.h"
+
+#include "CpuFeatures.h"
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#if defined(DXF2JEO_X86_64)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+    std::uint64_t matchScalar(const double*   x,
+                              const double*   y,
+                              const double*   z,
+                              std::uint64_t   begin,
+                              std::uint64_t   count,
+                              const JeoPoint& point,
+                              double          squaredTolerance)
+    {
+        auto matches = std::uint64_t{0};
+        for (auto i = begin; i < count; ++i) {
+            const double dx = x[i] - point.x;
+            const double dy = y[i] - point.y;
+            const double dz = z[i] - point.z;
+            if (dx * dx + dy * dy + dz * dz <= squaredTolerance)
+                matches |= std::uint64_t{1} << i;
+        }
+        return matches;
+    }
+
+#if defined(DXF2JEO_X86_64)
+
+    // SSE2 is part of x86-64, this kernel needs no runtime check
+    std::uint64_t matchSse2(const double* x, const double* y, const double* z, std::uint64_t count, const JeoPoint& point, double squaredTolerance)
+    {
+        const auto pointX    = _mm_set1_pd(point.x);
+        const auto pointY    = _mm_set1_pd(point.y);
+        const auto pointZ    = _mm_set1_pd(point.z);
+        const auto tolerance = _mm_set1_pd(squaredTolerance);
+
+        auto matches = std::uint64_t{0};
+        auto i       = std::uint64_t{0};
+        for (; i + 2 <= count; i += 2) {
+            const auto dx       = _mm_sub_pd(_mm_loadu_pd(x + i), pointX);
+            const auto dy       = _mm_sub_pd(_mm_loadu_pd(y + i), pointY);
+            const auto dz       = _mm_sub_pd(_mm_loadu_pd(z + i), pointZ);
+            const auto distance = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+            matches |= static_cast<std::uint64_t>(_mm_movemask_pd(_mm_cmple_pd(distance, tolerance))) << i;
+        }
+        return matches | matchScalar(x, y, z, i, count, point, squaredTolerance);
+    }
+
+    DXF2JEO_TARGET_AVX2 std::uint64_t matchAvx2(const double* x, const double* y, const double* z, std::uint64_t count, const JeoPoint& point, double squaredTolerance)
+    {
+        const auto pointX    = _mm256_set1_pd(point.x);
+        const auto pointY    = _mm256_set1_pd(point.y);
+        const auto pointZ    = _mm256_set1_pd(point.z);
+        const auto tolerance = _mm256_set1_pd(squaredTolerance);
+
+        auto matches = std::uint64_t{0};
+        auto i       = std::uint64_t{0};
+        for (; i + 4 <= count; i += 4) {
+            const auto dx       = _mm256_sub_pd(_mm256_loadu_pd(x + i), pointX);
+            const auto dy       = _mm256_sub_pd(_mm256_loadu_pd(y + i), pointY);
+            const auto dz       = _mm256_sub_pd(_mm256_loadu_pd(z + i), pointZ);
+            const auto distance = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz));
+            matches |= static_cast<std::uint64_t>(_mm256_movemask_pd(_mm256_cmp_pd(distance, tolerance, _CMP_LE_OQ))) << i;
+        }
+
+        // The compiler does not always clear the upper halves of the ymm registers on its own, the SSE code running next would then be slowed down
+        _mm256_zeroupper();
+        return matches | matchScalar(x, y, z, i, count, point, squaredTolerance);
+    }
+
+#endif
+}
+
+double toSquaredTolerance(double tolerance)
+{
+    // std::sqrt being correctly rounded and monotonic, the squares whose root does not exceed tolerance are all
+    // the values up to some threshold, found from the rounded square by stepping one representable value at a time
+    auto squared = tolerance * tolerance;
+    while (std::sqrt(squared) > tolerance)
+        squared = std::nextafter(squared, 0.);
+    while (std::sqrt(std::nextafter(squared, std::numeric_limits<double>::infinity())) <= tolerance)
+        squared = std::nextafter(squared, std::numeric_limits<double>::infinity());
+    return squared;
+}
+
+bool isSupported(DistanceKernel kernel)
+{
+    switch (kernel) {
+    case DistanceKernel::Scalar:
+        return true;
+#if defined(DXF2JEO_X86_64)
+    case DistanceKernel::Sse2:
+        return true;
+    case DistanceKernel::Avx2:
+        return hasAvx2();
+#endif
+    default:
+        return false;
+    }
+}
+
+DistanceKernel getBestDistanceKernel()
+{
+    static const auto kernel = []() {
+        for (const auto kernel : {DistanceKernel::Avx2, DistanceKernel::Sse2})
+            if (isSupported(kernel))
+                return kernel;
+        return DistanceKernel::Scalar;
+    }();
+    return kernel;
+}
+
+std::uint64_t matchWithinTolerance(DistanceKernel  kernel,
+                                   const double*   x,
+                                   const double*   y,
+                                   const double*   z,
+                                   std::uint64_t   count,
+                                   const JeoPoint& point,
+                                   double          squaredTolerance)
+{
+    if (count > DISTANCE_BLOCK_SIZE)
+        throw std::runtime_error{"too many candidate points"};
+
+    switch (kernel) {
+#if defined(DXF2JEO_X86_64)
+    case DistanceKernel::Sse2:
+        return matchSse2(x, y, z, count, point, squaredTolerance);
+    case DistanceKernel::Avx2:
+        return matchAvx2(x, y, z, count, point, squaredTolerance);
+#endif
+    default:
+        return matchScalar(x, y, z, 0, count, point, squaredTolerance);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "JeoModel.h"
+#include <cstdint>
+
+// Vectorised tolerance tests of one point against a block of candidate points.
+// Kernels compute dx * dx + dy * dy + dz * dz in the same order and compare it to toSquaredTolerance(tolerance),
+// so that every kernel returns exactly what std::sqrt(dx * dx + dy * dy + dz * dz) <= tolerance does.
+
+enum class DistanceKernel
+{
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+constexpr auto DISTANCE_BLOCK_SIZE = std::uint64_t{64};
+
+// Largest squared distance whose square root does not exceed tolerance
+double toSquaredTolerance(double tolerance);
+
+bool isSupported(DistanceKernel kernel);
+
+// Fastest kernel supported by the processor, chosen once
+DistanceKernel getBestDistanceKernel();
+
+// Bit i of the result is set when candidate i, of coordinates x[i], y[i] and z[i], lies within tolerance of point.
+// count must not exceed DISTANCE_BLOCK_SIZE.
+std::uint64_t matchWithinTolerance(DistanceKernel  kernel,
+                                   const double*   x,
+                                   const double*   y,
+                                   const double*   z,
+                                   std::uint64_t   count,
+                                   const JeoPoint& point,
+                                   double          squaredTolerance);
\ No newline at end of file
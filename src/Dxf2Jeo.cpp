@@ -4,15 +4,34 @@
 #include "DxfColors.h"
 #include "DxfModel.h"
 #include "JeoModel.h"
+#include "JeoPointIndex.h"
+#include "Parallel.h"
 #include <algorithm>
+#include <array>
 #include <cctype>
 #include <cmath>
 #include <stdexcept>
+#include <string>
 #include <string_view>
+#include <unordered_map>
 
 namespace {
     constexpr auto DISTANCE_TOLERANCE = 1e-3;
+}
+
+struct JeoBuilder
+{
+    JeoModel      jeoModel;
+    JeoPointIndex pointIndex{DISTANCE_TOLERANCE};
 
+    // Jeo color index of each already resolved dxf color
+    std::array<std::optional<std::uint64_t>, 256> colorIndexes;
+
+    // Jeo tag index of each already seen PE_URL, std::nullopt when it is not a valid tag
+    std::unordered_map<std::string, std::optional<std::uint64_t>> tagIndexes;
+};
+
+namespace {
     template<typename T> std::uint64_t add(std::vector<T>& values, T value)
     {
         const auto index = static_cast<std::uint64_t>(values.size());
@@ -20,15 +39,6 @@ namespace {
         return index;
     }
 
-    template<typename T> std::uint64_t addUnique(std::vector<T>& values, T value)
-    {
-        const auto it = std::find(values.begin(), values.end(), value);
-        if (it != values.end())
-            return static_cast<std::uint64_t>(std::distance(values.begin(), it));
-        else
-            return add(values, std::move(value));
-    }
-
     DxfCoord evaluate(const DxfArc& arc, double u)
     {
         const auto theta = arc.theta1 + u * (arc.theta2 - arc.theta1);
@@ -38,36 +48,32 @@ namespace {
         return {x, y, z};
     }
 
-    std::uint64_t addPoint(JeoModel& jeoModel, const DxfCoord& dxfCoord)
-    {
-        const auto it = std::find_if(jeoModel.points.begin(), jeoModel.points.end(), [&](const JeoPoint& jeoPoint) {
-            const double dx = jeoPoint.x - dxfCoord.x;
-            const double dy = jeoPoint.y - dxfCoord.y;
-            const double dz = jeoPoint.z - dxfCoord.z;
-            return std::sqrt(dx * dx + dy * dy + dz * dz) <= DISTANCE_TOLERANCE;
-        });
+    JeoPoint toJeoPoint(const DxfCoord& dxfCoord) { return {dxfCoord.x, dxfCoord.y, dxfCoord.z}; }
 
-        if (it != jeoModel.points.end())
-            return static_cast<std::uint64_t>(std::distance(jeoModel.points.begin(), it));
-
-        return add(jeoModel.points, {dxfCoord.x, dxfCoord.y, dxfCoord.z});
-    }
-
-    std::vector<std::uint64_t> addPoints(JeoModel& jeoModel, const std::vector<DxfCoord>& dxfCoords)
+    std::uint64_t addPoint(JeoBuilder& builder, const DxfCoord& dxfCoord)
     {
-        auto ids = std::vector<std::uint64_t>(dxfCoords.size());
-        std::transform(dxfCoords.begin(), dxfCoords.end(), ids.begin(), [&](const DxfCoord& dxfCoord) { return addPoint(jeoModel, dxfCoord); });
-        return ids;
+        const auto jeoPoint = toJeoPoint(dxfCoord);
+        if (const auto pointIndex = builder.pointIndex.find(builder.jeoModel.points, jeoPoint))
+            return *pointIndex;
+
+        const auto pointIndex = builder.jeoModel.points.size();
+        builder.jeoModel.points.push_back(jeoPoint);
+        builder.pointIndex.insert(jeoPoint, pointIndex);
+        return pointIndex;
     }
 
     bool isTagChar(char c) { return c == '_' || std::isalnum(static_cast<unsigned char>(c)); }
     bool isTag(std::string_view tag) { return std::all_of(tag.begin(), tag.end(), isTagChar); }
 
-    std::optional<std::uint64_t> addTag(JeoModel& jeoModel, const std::optional<std::string>& tag)
+    std::optional<std::uint64_t> addTag(JeoBuilder& builder, const std::optional<std::string>& tag)
     {
-        if (!tag || !isTag(*tag))
+        if (!tag)
             return std::nullopt;
-        return addUnique(jeoModel.tags, *tag);
+
+        const auto [it, inserted] = builder.tagIndexes.try_emplace(*tag);
+        if (inserted && isTag(*tag))
+            it->second = add(builder.jeoModel.tags, *tag);
+        return it->second;
     }
 
     JeoColor dxf2JeoColor(std::int64_t dxfColor)
@@ -93,69 +99,196 @@ namespace {
         return add(jeoModel.colors, jeoColor);
     }
 
-    std::optional<std::uint64_t> addColor(JeoModel& jeoModel, std::optional<std::int64_t> dxfColor)
+    std::optional<std::uint64_t> addColor(JeoBuilder& builder, std::optional<std::int64_t> dxfColor)
     {
         if (!dxfColor || *dxfColor <= 0 || *dxfColor > 255)
             return std::nullopt;
-        return addColor(jeoModel, *dxfColor);
+
+        // Several dxf colors share the same rgb value, the slow path is only taken once per dxf color
+        auto& colorIndex = builder.colorIndexes[static_cast<std::size_t>(*dxfColor)];
+        if (!colorIndex)
+            colorIndex = addColor(builder.jeoModel, *dxfColor);
+        return colorIndex;
     }
 
-    void setEntity(JeoModel& jeoModel, JeoEntity& jeoEntity, const DxfEntity& dxfEntity)
+    void setEntity(JeoBuilder& builder, JeoEntity& jeoEntity, const DxfEntity& dxfEntity)
     {
-        jeoEntity.colorIndex = addColor(jeoModel, dxfEntity.color);
-        jeoEntity.tagIndex   = addTag(jeoModel, dxfEntity.peURL);
+        jeoEntity.colorIndex = addColor(builder, dxfEntity.color);
+        jeoEntity.tagIndex   = addTag(builder, dxfEntity.peURL);
     }
 
-    void addLine(JeoModel& jeoModel, const DxfLine& dxfLine)
+    void addLine(JeoBuilder& builder, const DxfLine& dxfLine)
     {
         auto jeoLine            = JeoLine{};
-        jeoLine.firstPointIndex = addPoint(jeoModel, dxfLine.p1);
-        jeoLine.lastPointIndex  = addPoint(jeoModel, dxfLine.p2);
-        setEntity(jeoModel, jeoLine, dxfLine);
-        jeoModel.lines.push_back(jeoLine);
+        jeoLine.firstPointIndex = addPoint(builder, dxfLine.p1);
+        jeoLine.lastPointIndex  = addPoint(builder, dxfLine.p2);
+        setEntity(builder, jeoLine, dxfLine);
+        builder.jeoModel.lines.push_back(jeoLine);
     }
 
-    void addArc(JeoModel& jeoModel, const DxfArc& dxfArc)
+    void addArc(JeoBuilder& builder, const DxfArc& dxfArc)
     {
         auto jeoArc        = JeoArc{};
-        jeoArc.centerIndex = addPoint(jeoModel, dxfArc.center);
+        jeoArc.centerIndex = addPoint(builder, dxfArc.center);
         if (isNull2PI(dxfArc.theta1 - dxfArc.theta2)) {
-            const auto pointIndex  = addPoint(jeoModel, evaluate(dxfArc, 0.));
+            const auto pointIndex  = addPoint(builder, evaluate(dxfArc, 0.));
             jeoArc.firstPointIndex = pointIndex;
             jeoArc.lastPointIndex  = pointIndex;
             jeoArc.direct          = !isNull(dxfArc.theta1 - dxfArc.theta2);
         }
         else {
-            jeoArc.firstPointIndex = addPoint(jeoModel, evaluate(dxfArc, 0.));
-            jeoArc.lastPointIndex  = addPoint(jeoModel, evaluate(dxfArc, 1.));
+            jeoArc.firstPointIndex = addPoint(builder, evaluate(dxfArc, 0.));
+            jeoArc.lastPointIndex  = addPoint(builder, evaluate(dxfArc, 1.));
             jeoArc.direct          = dxfArc.theta1 <= dxfArc.theta2;
         }
-        setEntity(jeoModel, jeoArc, dxfArc);
-        jeoModel.arcs.push_back(jeoArc);
+        setEntity(builder, jeoArc, dxfArc);
+        builder.jeoModel.arcs.push_back(jeoArc);
     }
 
-    void addPolyline(JeoModel& jeoModel, const DxfPolyline& dxfPolyline)
+    void addPolyline(JeoBuilder& builder, const DxfPolyline& dxfPolyline)
     {
         if (dxfPolyline.coords.size() < 2)
             throw std::runtime_error{"unsupported polyline"};
 
-        auto jeoPolyline         = JeoPolyline{};
-        jeoPolyline.pointIndexes = addPoints(jeoModel, dxfPolyline.coords);
-        jeoPolyline.bulges       = dxfPolyline.bulges;
-        jeoPolyline.closed       = dxfPolyline.closed;
-        setEntity(jeoModel, jeoPolyline, dxfPolyline);
-        jeoModel.polylines.push_back(jeoPolyline);
+        // Vertices and bulges are appended straight to the arrays shared by all polylines
+        auto& jeoPolylines = builder.jeoModel.polylines;
+        for (const auto& dxfCoord : dxfPolyline.coords)
+            jeoPolylines.pointIndexes.push_back(addPoint(builder, dxfCoord));
+        if (dxfPolyline.bulges)
+            jeoPolylines.bulges.insert(jeoPolylines.bulges.end(), dxfPolyline.bulges->begin(), dxfPolyline.bulges->end());
+        jeoPolylines.pointOffsets.push_back(jeoPolylines.pointIndexes.size());
+        jeoPolylines.bulgeOffsets.push_back(jeoPolylines.bulges.size());
+
+        auto entity      = JeoPolylineEntity{};
+        entity.closed    = dxfPolyline.closed;
+        entity.hasBulges = dxfPolyline.bulges.has_value();
+        setEntity(builder, entity, dxfPolyline.entity);
+        jeoPolylines.entities.push_back(entity);
     }
 }
 
 JeoModel convertToJeo(const DxfModel& dxfModel)
 {
-    auto jeoModel = JeoModel{};
+    auto builder = JeoBuilder{};
     for (const auto& line : dxfModel.lines)
-        addLine(jeoModel, line);
+        addLine(builder, line);
     for (const auto& arc : dxfModel.arcs)
-        addArc(jeoModel, arc);
-    for (const auto& polyline : dxfModel.polylines)
-        addPolyline(jeoModel, polyline);
+        addArc(builder, arc);
+    for (std::uint64_t i = 0, n = dxfModel.polylines.size(); i < n; ++i)
+        addPolyline(builder, dxfModel.polylines[i]);
+    return std::move(builder.jeoModel);
+}
+
+JeoModel convertToJeo(const DxfModel& dxfModel, std::uint64_t threadCount)
+{
+    if (threadCount <= 1)
+        return convertToJeo(dxfModel);
+
+    const auto& dxfLines     = dxfModel.lines;
+    const auto& dxfArcs      = dxfModel.arcs;
+    const auto& dxfPolylines = dxfModel.polylines;
+
+    // Coordinates are laid out in the order the sequential conversion welds them
+    auto arcOffsets = std::vector<std::uint64_t>(dxfArcs.size() + 1, 2 * dxfLines.size());
+    for (std::uint64_t i = 0, n = dxfArcs.size(); i < n; ++i)
+        arcOffsets[i + 1] = arcOffsets[i] + (isNull2PI(dxfArcs[i].theta1 - dxfArcs[i].theta2) ? 2 : 3);
+
+    // Polyline coordinates are already stored back to back, they come last
+    const auto polylinesBegin = arcOffsets.back();
+    for (std::uint64_t i = 0, n = dxfPolylines.size(); i < n; ++i)
+        if (dxfPolylines.coordOffsets[i + 1] - dxfPolylines.coordOffsets[i] < 2)
+            throw std::runtime_error{"unsupported polyline"};
+
+    auto coords = JeoPoints{};
+    coords.resize(polylinesBegin + dxfPolylines.coords.size());
+    parallelFor(dxfLines.size(), threadCount, [&](std::uint64_t begin, std::uint64_t end) {
+        for (auto i = begin; i < end; ++i) {
+            coords.set(2 * i, toJeoPoint(dxfLines[i].p1));
+            coords.set(2 * i + 1, toJeoPoint(dxfLines[i].p2));
+        }
+    });
+    parallelFor(dxfArcs.size(), threadCount, [&](std::uint64_t begin, std::uint64_t end) {
+        for (auto i = begin; i < end; ++i) {
+            const auto offset = arcOffsets[i];
+            coords.set(offset, toJeoPoint(dxfArcs[i].center));
+            coords.set(offset + 1, toJeoPoint(evaluate(dxfArcs[i], 0.)));
+            if (arcOffsets[i + 1] - offset == 3)
+                coords.set(offset + 2, toJeoPoint(evaluate(dxfArcs[i], 1.)));
+        }
+    });
+    parallelFor(dxfPolylines.coords.size(), threadCount, [&](std::uint64_t begin, std::uint64_t end) {
+        for (auto i = begin; i < end; ++i)
+            coords.set(polylinesBegin + i, toJeoPoint(dxfPolylines.coords[i]));
+    });
+
+    auto weldedPoints = weldPoints(coords, DISTANCE_TOLERANCE, threadCount);
+    coords            = {};
+
+    const auto& pointIndexes = weldedPoints.pointIndexes;
+    auto        builder      = JeoBuilder{};
+    auto&       jeoModel     = builder.jeoModel;
+    jeoModel.points          = std::move(weldedPoints.points);
+    jeoModel.lines.resize(dxfLines.size());
+    jeoModel.arcs.resize(dxfArcs.size());
+
+    parallelFor(dxfLines.size(), threadCount, [&](std::uint64_t begin, std::uint64_t end) {
+        for (auto i = begin; i < end; ++i) {
+            jeoModel.lines[i].firstPointIndex = pointIndexes[2 * i];
+            jeoModel.lines[i].lastPointIndex  = pointIndexes[2 * i + 1];
+        }
+    });
+    parallelFor(dxfArcs.size(), threadCount, [&](std::uint64_t begin, std::uint64_t end) {
+        for (auto i = begin; i < end; ++i) {
+            const auto& dxfArc = dxfArcs[i];
+            auto&       jeoArc = jeoModel.arcs[i];
+            const auto  offset = arcOffsets[i];
+            jeoArc.centerIndex = pointIndexes[offset];
+            if (arcOffsets[i + 1] - offset == 2) {
+                jeoArc.firstPointIndex = pointIndexes[offset + 1];
+                jeoArc.lastPointIndex  = pointIndexes[offset + 1];
+                jeoArc.direct          = !isNull(dxfArc.theta1 - dxfArc.theta2);
+            }
+            else {
+                jeoArc.firstPointIndex = pointIndexes[offset + 1];
+                jeoArc.lastPointIndex  = pointIndexes[offset + 2];
+                jeoArc.direct          = dxfArc.theta1 <= dxfArc.theta2;
+            }
+        }
+    });
+
+    // Both models lay polylines out the same way, the welded indexes of their coordinates being already in order
+    auto& jeoPolylines = jeoModel.polylines;
+    jeoPolylines.pointIndexes.assign(pointIndexes.begin() + polylinesBegin, pointIndexes.end());
+    jeoPolylines.pointOffsets = dxfPolylines.coordOffsets;
+    jeoPolylines.bulgeOffsets = dxfPolylines.bulgeOffsets;
+    jeoPolylines.bulges       = dxfPolylines.bulges;
+    jeoPolylines.entities.resize(dxfPolylines.size());
+    for (std::uint64_t i = 0, n = dxfPolylines.size(); i < n; ++i) {
+        jeoPolylines.entities[i].closed    = dxfPolylines.entities[i].closed;
+        jeoPolylines.entities[i].hasBulges = dxfPolylines.entities[i].hasBulges;
+    }
+
+    // Colors and tags are numbered in first-seen order as well, which is cheap enough to stay sequential
+    for (std::uint64_t i = 0, n = dxfLines.size(); i < n; ++i)
+        setEntity(builder, jeoModel.lines[i], dxfLines[i]);
+    for (std::uint64_t i = 0, n = dxfArcs.size(); i < n; ++i)
+        setEntity(builder, jeoModel.arcs[i], dxfArcs[i]);
+    for (std::uint64_t i = 0, n = dxfPolylines.size(); i < n; ++i)
+        setEntity(builder, jeoPolylines.entities[i], dxfPolylines.entities[i]);
+
+    return std::move(jeoModel);
+}
+
+Dxf2JeoConverter::Dxf2JeoConverter() : builder_{std::make_unique<JeoBuilder>()} {}
+Dxf2JeoConverter::~Dxf2JeoConverter() = default;
+
+void Dxf2JeoConverter::addLine(const DxfLine& line) { ::addLine(*builder_, line); }
+void Dxf2JeoConverter::addArc(const DxfArc& arc) { ::addArc(*builder_, arc); }
+void Dxf2JeoConverter::addPolyline(const DxfPolyline& polyline) { ::addPolyline(*builder_, polyline); }
+
+JeoModel Dxf2JeoConverter::takeModel()
+{
+    auto jeoModel = std::move(builder_->jeoModel);
+    builder_      = std::make_unique<JeoBuilder>();
     return jeoModel;
 }
\ No newline at end of file
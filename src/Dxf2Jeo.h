@@ -1,6 +1,34 @@
 #pragma once
 
+#include "DxfReader.h"
+#include <cstdint>
+#include <memory>
+
 class DxfModel;
 class JeoModel;
+struct JeoBuilder;
+
+JeoModel convertToJeo(const DxfModel& dxfModel);
+
+// Same result as convertToJeo(dxfModel), entities and point welding being spread over threadCount threads
+JeoModel convertToJeo(const DxfModel& dxfModel, std::uint64_t threadCount);
+
+// Converts entities as they arrive, typically from readDxf, so that no DxfModel has to be stored.
+// Points, colors and tags are numbered in arrival order, convertToJeo numbering all lines first,
+// then arcs and polylines: both models describe the same entities, welded points being the first
+// ones seen within tolerance.
+class Dxf2JeoConverter : public DxfEntitySink
+{
+  public:
+    Dxf2JeoConverter();
+    ~Dxf2JeoConverter() override;
+
+    void addLine(const DxfLine& line) override;
+    void addArc(const DxfArc& arc) override;
+    void addPolyline(const DxfPolyline& polyline) override;
+
+    JeoModel takeModel();
 
-JeoModel convertToJeo(const DxfModel& dxfModel);
\ No newline at end of file
+  private:
+    std::unique_ptr<JeoBuilder> builder_;
+};
\ No newline at end of file
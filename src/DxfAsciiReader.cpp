@@ -0,0 +1,572 @@
+#include "DxfAsciiReader.h"
+
+#include "ArcUtils.h"
+#include "DxfModel.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fmt/format.h>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+    static const auto PI = std::atan(1.) * 4;
+
+    // Degrees per radian as libdxfrw defines it, arc angles being divided by it
+    constexpr auto ARAD = 57.29577951308232;
+
+    // Defaults of libdxfrw for what a record leaves out
+    constexpr auto BY_LAYER            = std::int64_t{256};
+    constexpr auto DEFAULT_LAYER_COLOR = std::int64_t{7};
+    constexpr auto DEFAULT_LAYER       = std::string_view{"0"};
+
+    struct Group
+    {
+        int              code = 0;
+        std::string_view value;
+    };
+
+    // Groups of an ASCII dxf file, a code line followed by a value line, viewed in place. Lines may end with \r\n.
+    class GroupReader
+    {
+      public:
+        explicit GroupReader(std::string_view contents) : contents_{contents} {}
+
+        // Reads the next group, returns false once the contents are exhausted
+        bool next()
+        {
+            if (position_ == contents_.size())
+                return hasGroup_ = false;
+
+            groupBegin_         = position_;
+            const auto codeLine = readLine();
+            if (position_ == contents_.size() && trim(codeLine).empty())
+                return hasGroup_ = false;
+            group_.code = parseCode(codeLine);
+            if (position_ == contents_.size())
+                throw std::runtime_error{fmt::format("missing value of dxf group {} at line {}", group_.code, lineNumber())};
+            group_.value = readLine();
+            return hasGroup_ = true;
+        }
+
+        // Reads the next group of the current record, returns false on the first group of the next one or at the end
+        bool nextInRecord() { return next() && group_.code != 0; }
+
+        bool         hasGroup() const { return hasGroup_; }
+        const Group& group() const { return group_; }
+
+        // Offsets of the code line of the current group and of the line following it
+        std::size_t groupBegin() const { return groupBegin_; }
+        std::size_t position() const { return position_; }
+
+        // Moves to a line start, the next group being read from there
+        void seek(std::size_t position)
+        {
+            position_ = position;
+            hasGroup_ = false;
+        }
+
+        // Number of the last line read, only counted for error messages as readers of chunks start anywhere in the contents
+        std::uint64_t lineNumber() const { return std::count(contents_.begin(), contents_.begin() + position_, '\n'); }
+
+        // Numbers may be padded with spaces and signed with +, libdxfrw reading them through streams
+        double toDouble() const { return toNumber<double>(); }
+        int    toInt() const { return toNumber<int>(); }
+
+        static std::string_view trim(std::string_view text)
+        {
+            const auto begin = text.find_first_not_of(" \t");
+            if (begin == std::string_view::npos)
+                return {};
+            return text.substr(begin, text.find_last_not_of(" \t") - begin + 1);
+        }
+
+      private:
+        std::string_view readLine()
+        {
+            const auto begin = position_;
+            const auto end   = std::min(contents_.find('\n', begin), contents_.size());
+            position_        = std::min(end + 1, contents_.size());
+
+            auto line = contents_.substr(begin, end - begin);
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+            return line;
+        }
+
+        int parseCode(std::string_view line) const
+        {
+            const auto text   = trim(line);
+            auto       code   = 0;
+            const auto result = std::from_chars(text.data(), text.data() + text.size(), code);
+            if (text.empty() || result.ec != std::errc{} || result.ptr != text.data() + text.size())
+                throw std::runtime_error{fmt::format("invalid dxf group code {} at line {}", line, lineNumber())};
+            return code;
+        }
+
+        template<typename T> T toNumber() const
+        {
+            auto text = trim(group_.value);
+            if (!text.empty() && text.front() == '+')
+                text.remove_prefix(1);
+            auto       value  = T{};
+            const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+            if (text.empty() || result.ec != std::errc{} || result.ptr != text.data() + text.size())
+                throw std::runtime_error{fmt::format("invalid value {} of dxf group {} at line {}", group_.value, group_.code, lineNumber())};
+            return value;
+        }
+
+        std::string_view contents_;
+        std::size_t      position_   = 0;
+        std::size_t      groupBegin_ = 0;
+        Group            group_;
+        bool             hasGroup_ = false;
+    };
+
+    // Groups shared by all entities. Application groups between 102 {NAME and 102 } are left out, as libdxfrw sets them
+    // aside, and PE_URL extended data is the first string following the PE_URL application name.
+    class EntityParser
+    {
+      public:
+        EntityParser() { entity.layer = DEFAULT_LAYER; }
+
+        // Returns whether the group was one of the common ones
+        bool parse(GroupReader& reader)
+        {
+            const auto& group = reader.group();
+            switch (group.code) {
+            case 8: entity.layer = group.value; return true;
+            case 62:
+                if (const auto color = reader.toInt(); color != BY_LAYER)
+                    entity.color = color;
+                else
+                    entity.color.reset();
+                return true;
+            case 102: skipApplicationGroup(reader); return true;
+            case 1000:
+                if (isPEURLApplication_ && !entity.peURL)
+                    entity.peURL = group.value;
+                return true;
+            case 1001: isPEURLApplication_ = group.value == "PE_URL"; return true;
+            default: return false;
+            }
+        }
+
+        DxfEntity entity;
+
+      private:
+        static void skipApplicationGroup(GroupReader& reader)
+        {
+            if (reader.group().value.substr(0, 1) != "{")
+                return;
+            while (reader.next() && reader.group().code != 102) {}
+        }
+
+        bool isPEURLApplication_ = false;
+    };
+
+    // Extrusion direction of an entity, with its arbitrary axes computed as libdxfrw does. As there, only group 210 marks
+    // the direction as given.
+    class Extrusion
+    {
+      public:
+        // Returns whether the group was one of the extrusion direction
+        bool parse(const GroupReader& reader)
+        {
+            switch (reader.group().code) {
+            case 210:
+                direction_.x = reader.toDouble();
+                isSet_       = true;
+                return true;
+            case 220: direction_.y = reader.toDouble(); return true;
+            case 230: direction_.z = reader.toDouble(); return true;
+            default: return false;
+            }
+        }
+
+        bool            isSet() const { return isSet_; }
+        const DxfCoord& direction() const { return direction_; }
+
+        // Whether the entity is drawn on a plane seen from below, the axes being mirrored
+        bool isReversed() const { return std::fabs(direction_.x) < AXIS_THRESHOLD && std::fabs(direction_.y) < AXIS_THRESHOLD && direction_.z < 0.; }
+
+        // World coordinates of a point given in the coordinate system of the entity
+        DxfCoord apply(const DxfCoord& point) const
+        {
+            const auto& n     = direction_;
+            const auto  axisX = getAxisX();
+            const auto  axisY = unitize({n.y * axisX.z - axisX.y * n.z, n.z * axisX.x - axisX.z * n.x, n.x * axisX.y - axisX.x * n.y});
+            return {axisX.x * point.x + axisY.x * point.y + n.x * point.z,
+                    axisX.y * point.x + axisY.y * point.y + n.y * point.z,
+                    axisX.z * point.x + axisY.z * point.y + n.z * point.z};
+        }
+
+      private:
+        static constexpr auto AXIS_THRESHOLD = 1. / 64;
+
+        static DxfCoord unitize(DxfCoord v)
+        {
+            const auto length = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+            if (length > 0.)
+                v = {v.x / length, v.y / length, v.z / length};
+            return v;
+        }
+
+        // World Y crossed with the direction when it is close to world Z, world Z crossed with it otherwise
+        DxfCoord getAxisX() const
+        {
+            const auto& n = direction_;
+            if (std::fabs(n.x) < AXIS_THRESHOLD && std::fabs(n.y) < AXIS_THRESHOLD)
+                return unitize({n.z, 0., -n.x});
+            return unitize({-n.y, n.x, 0.});
+        }
+
+        DxfCoord direction_ = {0., 0., 1.};
+        bool     isSet_     = false;
+    };
+
+    class DxfAsciiParser
+    {
+      public:
+        DxfAsciiParser(std::string_view contents, DxfRecordHandler& handler) : reader_{contents}, handler_{&handler} {}
+
+        // Parses sections up to EOF and returns false. With stopAtEntities, returns true instead on reaching an ENTITIES section,
+        // the reader being left after its name.
+        bool parse(bool stopAtEntities = false)
+        {
+            while (reader_.next()) {
+                const auto& group = reader_.group();
+                if (group.code != 0)
+                    continue;
+                if (group.value == "EOF")
+                    return false;
+                if (group.value != "SECTION")
+                    continue;
+
+                if (!reader_.next() || reader_.group().code != 2)
+                    throw std::runtime_error{fmt::format("missing dxf section name at line {}", reader_.lineNumber())};
+                const auto name = reader_.group().value;
+                if (name == "ENTITIES" && stopAtEntities)
+                    return true;
+                if (name == "TABLES")
+                    parseRecords([this](std::string_view type) { parseTableRecord(type); });
+                else if (name == "BLOCKS" || name == "ENTITIES")
+                    parseEntities();
+                else
+                    skipSection();
+            }
+            return false;
+        }
+
+        // Parses the entities following the reader position up to ENDSEC, or up to the first record starting at or after end
+        void parseEntities(std::size_t end = std::string_view::npos)
+        {
+            parseRecords([this](std::string_view type) { parseEntity(type); }, end);
+        }
+
+        std::size_t position() const { return reader_.position(); }
+        void        seek(std::size_t position) { reader_.seek(position); }
+
+      private:
+        // Parses the records of a section up to ENDSEC or up to the first record starting at or after end, each record parser
+        // leaving the reader on the first group of the next record
+        template<typename RecordParser> void parseRecords(const RecordParser& parseRecord, std::size_t end = std::string_view::npos)
+        {
+            reader_.next();
+            while (reader_.hasGroup()) {
+                const auto& group = reader_.group();
+                if (group.code != 0)
+                    reader_.next();
+                else if (reader_.groupBegin() >= end || group.value == "ENDSEC")
+                    return;
+                else
+                    parseRecord(group.value);
+            }
+        }
+
+        void skipSection()
+        {
+            while (reader_.next())
+                if (reader_.group().code == 0 && reader_.group().value == "ENDSEC")
+                    return;
+        }
+
+        void skipRecord()
+        {
+            while (reader_.nextInRecord()) {}
+        }
+
+        // Table headers and entries of other tables are skipped
+        void parseTableRecord(std::string_view type)
+        {
+            if (type == "LAYER")
+                parseLayer();
+            else
+                skipRecord();
+        }
+
+        void parseEntity(std::string_view type)
+        {
+            if (type == "LINE")
+                parseLine();
+            else if (type == "ARC")
+                parseArc();
+            else if (type == "LWPOLYLINE")
+                parsePolyline();
+            else
+                skipRecord();
+        }
+
+        void parseLayer()
+        {
+            auto layer  = DxfLayer{};
+            layer.color = DEFAULT_LAYER_COLOR;
+            while (reader_.nextInRecord()) {
+                const auto& group = reader_.group();
+                if (group.code == 2)
+                    layer.name = group.value;
+                else if (group.code == 62)
+                    layer.color = reader_.toInt();
+            }
+            handler_->addLayer(layer);
+        }
+
+        // Lines are in world coordinates, whatever their extrusion
+        void parseLine()
+        {
+            auto entity = EntityParser{};
+            auto line   = DxfLine{};
+            while (reader_.nextInRecord()) {
+                switch (reader_.group().code) {
+                case 10: line.p1.x = reader_.toDouble(); break;
+                case 20: line.p1.y = reader_.toDouble(); break;
+                case 30: line.p1.z = reader_.toDouble(); break;
+                case 11: line.p2.x = reader_.toDouble(); break;
+                case 21: line.p2.y = reader_.toDouble(); break;
+                case 31: line.p2.z = reader_.toDouble(); break;
+                default: entity.parse(reader_); break;
+                }
+            }
+            static_cast<DxfEntity&>(line) = std::move(entity.entity);
+            handler_->addLine(line);
+        }
+
+        // Angles of arcs seen from below are mirrored and swapped before being normalized the other way round
+        void parseArc()
+        {
+            auto entity    = EntityParser{};
+            auto extrusion = Extrusion{};
+            auto arc       = DxfArc{};
+            while (reader_.nextInRecord()) {
+                switch (reader_.group().code) {
+                case 10: arc.center.x = reader_.toDouble(); break;
+                case 20: arc.center.y = reader_.toDouble(); break;
+                case 30: arc.center.z = reader_.toDouble(); break;
+                case 40: arc.radius = reader_.toDouble(); break;
+                case 50: arc.theta1 = reader_.toDouble() / ARAD; break;
+                case 51: arc.theta2 = reader_.toDouble() / ARAD; break;
+                default:
+                    if (!extrusion.parse(reader_))
+                        entity.parse(reader_);
+                    break;
+                }
+            }
+            static_cast<DxfEntity&>(arc) = std::move(entity.entity);
+
+            if (extrusion.isSet()) {
+                arc.center = extrusion.apply(arc.center);
+                if (extrusion.isReversed()) {
+                    arc.theta1 = PI - arc.theta1;
+                    arc.theta2 = PI - arc.theta2;
+                    std::swap(arc.theta1, arc.theta2);
+                }
+            }
+            normalize(arc.theta1, arc.theta2, extrusion.direction().z > 0.);
+            handler_->addArc(arc);
+        }
+
+        // Vertices are gathered into buffers only allocated once, their z being the elevation of the polyline. Bulges are left
+        // out when all of them are null.
+        void parsePolyline()
+        {
+            auto entity    = EntityParser{};
+            auto extrusion = Extrusion{};
+            auto flags     = 0;
+            auto elevation = 0.;
+            coords_.clear();
+            bulges_.clear();
+            while (reader_.nextInRecord()) {
+                switch (reader_.group().code) {
+                case 10:
+                    coords_.push_back({reader_.toDouble(), 0., 0.});
+                    bulges_.push_back(0.);
+                    break;
+                case 20:
+                    if (!coords_.empty())
+                        coords_.back().y = reader_.toDouble();
+                    break;
+                case 42:
+                    if (!bulges_.empty())
+                        bulges_.back() = reader_.toDouble();
+                    break;
+                case 38: elevation = reader_.toDouble(); break;
+                case 70: flags = reader_.toInt(); break;
+                default:
+                    if (!extrusion.parse(reader_))
+                        entity.parse(reader_);
+                    break;
+                }
+            }
+
+            for (auto& coord : coords_) {
+                coord.z = elevation;
+                if (extrusion.isSet()) {
+                    const auto world = extrusion.apply(coord);
+                    coord.x          = world.x;
+                    coord.y          = world.y;
+                }
+            }
+            const auto isBulge   = [](double bulge) { return std::fabs(bulge) > std::numeric_limits<double>::epsilon(); };
+            const auto hasBulges = std::any_of(bulges_.begin(), bulges_.end(), isBulge);
+            const auto bulges    = hasBulges ? std::optional{ArrayView<double>{bulges_}} : std::nullopt;
+            handler_->addPolyline({entity.entity, coords_, bulges, (flags & 1) != 0});
+        }
+
+        GroupReader           reader_;
+        DxfRecordHandler*     handler_;
+        std::vector<DxfCoord> coords_;
+        std::vector<double>   bulges_;
+    };
+
+    void checkAscii(std::string_view contents)
+    {
+        if (contents.substr(0, 18) == "AutoCAD Binary DXF")
+            throw std::runtime_error{"binary dxf files are not supported by the native reader"};
+    }
+
+    class ModelBuilder : public DxfRecordHandler
+    {
+      public:
+        void addLayer(const DxfLayer& layer) override { model.layers.push_back(layer); }
+        void addLine(const DxfLine& line) override { model.lines.push_back(line); }
+        void addArc(const DxfArc& arc) override { model.arcs.push_back(arc); }
+        void addPolyline(const DxfPolyline& polyline) override { model.polylines.push_back(polyline); }
+
+        DxfModel model;
+    };
+
+    void appendEntities(DxfModel& model, DxfModel&& chunkModel)
+    {
+        model.lines.insert(model.lines.end(), std::make_move_iterator(chunkModel.lines.begin()), std::make_move_iterator(chunkModel.lines.end()));
+        model.arcs.insert(model.arcs.end(), std::make_move_iterator(chunkModel.arcs.begin()), std::make_move_iterator(chunkModel.arcs.end()));
+        model.polylines.append(chunkModel.polylines);
+    }
+
+    bool isGroupCode(std::string_view line)
+    {
+        const auto text   = GroupReader::trim(line);
+        auto       code   = 0;
+        const auto result = std::from_chars(text.data(), text.data() + text.size(), code);
+        return !text.empty() && result.ec == std::errc{} && result.ptr == text.data() + text.size();
+    }
+
+    // Line starting at begin without its line break, and offset of the next line
+    std::pair<std::string_view, std::size_t> getLine(std::string_view contents, std::size_t begin)
+    {
+        const auto end  = std::min(contents.find('\n', begin), contents.size());
+        auto       line = contents.substr(begin, end - begin);
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        return {line, std::min(end + 1, contents.size())};
+    }
+
+    std::size_t findLineBegin(std::string_view contents, std::size_t position)
+    {
+        const auto lineBreak = position == 0 ? std::string_view::npos : contents.rfind('\n', position - 1);
+        return lineBreak == std::string_view::npos ? 0 : lineBreak + 1;
+    }
+
+    // Offset of the first record starting at or after from, or of the end of the contents. Records start with a 0 code line
+    // followed by their type. A value line reading 0 is followed by a code line instead, which tells them apart.
+    std::size_t findRecordBegin(std::string_view contents, std::size_t from)
+    {
+        auto lineBegin = from == 0 ? 0 : std::min(contents.find('\n', from - 1), contents.size() - 1) + 1;
+        while (lineBegin < contents.size()) {
+            const auto [line, nextBegin] = getLine(contents, lineBegin);
+            if (GroupReader::trim(line) == "0" && nextBegin < contents.size() && !isGroupCode(getLine(contents, nextBegin).first))
+                return lineBegin;
+            lineBegin = nextBegin;
+        }
+        return contents.size();
+    }
+
+    // Offset of the ENDSEC record closing the section going on at begin, or of the end of the contents. ENDSEC not being a group
+    // code, a line reading it after a 0 line can only be the type of a record, which the strings of the section are searched for.
+    std::size_t findSectionEnd(std::string_view contents, std::size_t begin)
+    {
+        for (auto found = contents.find("ENDSEC", begin); found != std::string_view::npos; found = contents.find("ENDSEC", found + 1)) {
+            const auto typeBegin = findLineBegin(contents, found);
+            if (typeBegin <= begin || GroupReader::trim(getLine(contents, typeBegin).first) != "ENDSEC")
+                continue;
+
+            const auto codeBegin = findLineBegin(contents, typeBegin - 1);
+            if (codeBegin >= begin && GroupReader::trim(getLine(contents, codeBegin).first) == "0")
+                return codeBegin;
+        }
+        return contents.size();
+    }
+
+    // Splits the contents following begin into chunkCount ranges of similar sizes starting on records, the last one ending with the contents
+    std::vector<std::size_t> splitRecords(std::string_view contents, std::size_t begin, std::uint64_t chunkCount)
+    {
+        auto boundaries = std::vector<std::size_t>{begin};
+        for (std::uint64_t i = 1; i < chunkCount; ++i) {
+            const auto target = begin + (contents.size() - begin) * i / chunkCount;
+            boundaries.push_back(findRecordBegin(contents, std::max(target, boundaries.back())));
+        }
+        boundaries.push_back(contents.size());
+        return boundaries;
+    }
+
+    DxfModel parseEntityChunk(std::string_view contents, std::size_t begin, std::size_t end)
+    {
+        auto builder = ModelBuilder{};
+        auto parser  = DxfAsciiParser{contents, builder};
+        parser.seek(begin);
+        parser.parseEntities(end);
+        return std::move(builder.model);
+    }
+}
+
+void readDxfAscii(std::string_view contents, DxfRecordHandler& handler)
+{
+    checkAscii(contents);
+    DxfAsciiParser{contents, handler}.parse();
+}
+
+DxfModel readDxfAscii(std::string_view contents, std::uint64_t threadCount)
+{
+    checkAscii(contents);
+    auto builder = ModelBuilder{};
+    auto parser  = DxfAsciiParser{contents, builder};
+    while (parser.parse(threadCount > 1)) {
+        // Only the entities are split, sequential parsing resuming on the ENDSEC record that closes them
+        const auto entities   = contents.substr(0, findSectionEnd(contents, parser.position()));
+        const auto boundaries = splitRecords(entities, parser.position(), threadCount);
+        auto       chunks     = std::vector<DxfModel>(boundaries.size() - 1);
+        parallelFor(chunks.size(), threadCount, [&](std::uint64_t begin, std::uint64_t end) {
+            for (auto i = begin; i < end; ++i)
+                chunks[i] = parseEntityChunk(contents, boundaries[i], boundaries[i + 1]);
+        });
+
+        for (auto& chunk : chunks)
+            appendEntities(builder.model, std::move(chunk));
+        parser.seek(entities.size());
+    }
+    return std::move(builder.model);
+}
\ No newline at end of file
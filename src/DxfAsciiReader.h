@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+struct DxfArc;
+struct DxfLayer;
+struct DxfLine;
+struct DxfModel;
+struct DxfPolyline;
+
+// Receives the layers and entities of a dxf file in file order, as libdxfrw passes them to a DRW_Interface
+class DxfRecordHandler
+{
+  public:
+    virtual ~DxfRecordHandler() = default;
+
+    virtual void addLayer(const DxfLayer& layer)          = 0;
+    virtual void addLine(const DxfLine& line)             = 0;
+    virtual void addArc(const DxfArc& arc)                = 0;
+    virtual void addPolyline(const DxfPolyline& polyline) = 0;
+};
+
+// Reads the contents of an ASCII dxf file without libdxfrw, group values being viewed in place and numbers parsed with from_chars.
+// Only LAYER table entries and LINE, ARC and LWPOLYLINE entities of the BLOCKS and ENTITIES sections are parsed, everything else
+// being skipped group by group. Values are interpreted as libdxfrw does, extrusions included, arcs coming normalized as readDxf
+// returns them and ByLayer entities without color. Text is passed as it is in the file, which is UTF-8 from AutoCAD 2007 on.
+void readDxfAscii(std::string_view contents, DxfRecordHandler& handler);
+
+// Same as readDxfAscii, the records being stored into a model, ByLayer entities without color. The ENTITIES section is split at
+// record boundaries into chunks parsed on up to threadCount threads, after the sections preceding it, which are read on one. The
+// chunks are concatenated in file order, so that the model does not depend on the thread count.
+DxfModel readDxfAscii(std::string_view contents, std::uint64_t threadCount);
\ No newline at end of file
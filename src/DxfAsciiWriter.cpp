@@ -0,0 +1,813 @@
+#include "DxfAsciiWriter.h"
+
+#include "DxfModel.h"
+#include <algorithm>
+#include <cstdint>
+#include <fmt/format.h>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+    // Same factor as libdxfrw, so that angles read back through it come out as they were
+    constexpr auto DEGREES_PER_RADIAN = 180. / 3.14159265358979323846;
+
+    // Formatted groups are written out once the buffer holds that many bytes
+    constexpr auto BUFFER_SIZE = std::size_t{1} << 20;
+
+    // Handles of the objects the constant sections below refer to, then the first one left for the model
+    constexpr auto LAYER_TABLE_HANDLE = std::uint64_t{0x2};
+    constexpr auto APPID_TABLE_HANDLE = std::uint64_t{0x9};
+    constexpr auto LAYER_0_HANDLE     = std::uint64_t{0x10};
+    constexpr auto ACAD_APPID_HANDLE  = std::uint64_t{0x12};
+    constexpr auto MODEL_SPACE_HANDLE = std::uint64_t{0x1F};
+    constexpr auto FIRST_FREE_HANDLE  = std::uint64_t{0x34};
+
+    // Header variables up to $HANDSEED, whose value depends on the number of objects
+    constexpr auto HEADER = std::string_view{R"(  0
+SECTION
+  2
+HEADER
+  9
+$ACADVER
+  1
+AC1027
+  9
+$DWGCODEPAGE
+  3
+ANSI_1252
+  9
+$INSBASE
+ 10
+0
+ 20
+0
+ 30
+0
+  9
+$EXTMIN
+ 10
+1e+20
+ 20
+1e+20
+ 30
+1e+20
+  9
+$EXTMAX
+ 10
+-1e+20
+ 20
+-1e+20
+ 30
+-1e+20
+  9
+$LIMMIN
+ 10
+0
+ 20
+0
+  9
+$LIMMAX
+ 10
+420
+ 20
+297
+  9
+$MEASUREMENT
+ 70
+1
+  9
+$INSUNITS
+ 70
+0
+  9
+$HANDSEED
+)"};
+
+    constexpr auto HEADER_END_AND_CLASSES = std::string_view{R"(  0
+ENDSEC
+  0
+SECTION
+  2
+CLASSES
+  0
+ENDSEC
+)"};
+
+    // Tables libdxfrw writes by default, around the layer and application tables which are written from the model
+    constexpr auto VPORT_AND_LTYPE_TABLES = std::string_view{R"(  0
+SECTION
+  2
+TABLES
+  0
+TABLE
+  2
+VPORT
+  5
+8
+330
+0
+100
+AcDbSymbolTable
+ 70
+1
+  0
+VPORT
+  5
+31
+330
+8
+100
+AcDbSymbolTableRecord
+100
+AcDbViewportTableRecord
+  2
+*ACTIVE
+ 70
+0
+ 10
+0
+ 20
+0
+ 11
+1
+ 21
+1
+ 12
+0.651828
+ 22
+-0.16
+ 13
+0
+ 23
+0
+ 14
+10
+ 24
+10
+ 15
+10
+ 25
+10
+ 16
+0
+ 26
+0
+ 36
+1
+ 17
+0
+ 27
+0
+ 37
+0
+ 40
+5.13732
+ 41
+2.4426877
+ 42
+50
+ 43
+0
+ 44
+0
+ 50
+0
+ 51
+0
+ 71
+0
+ 72
+100
+ 73
+1
+ 74
+3
+ 75
+0
+ 76
+0
+ 77
+0
+ 78
+0
+281
+0
+ 65
+1
+110
+0
+120
+0
+130
+0
+111
+1
+121
+0
+131
+0
+112
+0
+122
+1
+132
+0
+ 79
+0
+146
+0
+ 60
+7
+ 61
+5
+292
+1
+282
+1
+141
+0
+142
+0
+ 63
+250
+421
+3358443
+  0
+ENDTAB
+  0
+TABLE
+  2
+LTYPE
+  5
+5
+330
+0
+100
+AcDbSymbolTable
+ 70
+3
+  0
+LTYPE
+  5
+14
+330
+5
+100
+AcDbSymbolTableRecord
+100
+AcDbLinetypeTableRecord
+  2
+ByBlock
+ 70
+0
+  3
+
+ 72
+65
+ 73
+0
+ 40
+0
+  0
+LTYPE
+  5
+15
+330
+5
+100
+AcDbSymbolTableRecord
+100
+AcDbLinetypeTableRecord
+  2
+ByLayer
+ 70
+0
+  3
+
+ 72
+65
+ 73
+0
+ 40
+0
+  0
+LTYPE
+  5
+16
+330
+5
+100
+AcDbSymbolTableRecord
+100
+AcDbLinetypeTableRecord
+  2
+Continuous
+ 70
+0
+  3
+Solid line
+ 72
+65
+ 73
+0
+ 40
+0
+  0
+ENDTAB
+)"};
+
+    constexpr auto STYLE_VIEW_AND_UCS_TABLES = std::string_view{R"(  0
+TABLE
+  2
+STYLE
+  5
+3
+330
+0
+100
+AcDbSymbolTable
+ 70
+1
+  0
+STYLE
+  5
+32
+330
+3
+100
+AcDbSymbolTableRecord
+100
+AcDbTextStyleTableRecord
+  2
+Standard
+ 70
+0
+ 40
+0
+ 41
+1
+ 50
+0
+ 71
+0
+ 42
+1
+  3
+txt
+  4
+
+  0
+ENDTAB
+  0
+TABLE
+  2
+VIEW
+  5
+6
+330
+0
+100
+AcDbSymbolTable
+ 70
+0
+  0
+ENDTAB
+  0
+TABLE
+  2
+UCS
+  5
+7
+330
+0
+100
+AcDbSymbolTable
+ 70
+0
+  0
+ENDTAB
+)"};
+
+    constexpr auto DIMSTYLE_AND_BLOCK_RECORD_TABLES_AND_BLOCKS = std::string_view{R"(  0
+TABLE
+  2
+DIMSTYLE
+  5
+A
+330
+0
+100
+AcDbSymbolTable
+ 70
+1
+100
+AcDbDimStyleTable
+ 71
+1
+  0
+DIMSTYLE
+105
+33
+330
+A
+100
+AcDbSymbolTableRecord
+100
+AcDbDimStyleTableRecord
+  2
+Standard
+ 70
+0
+  0
+ENDTAB
+  0
+TABLE
+  2
+BLOCK_RECORD
+  5
+1
+330
+0
+100
+AcDbSymbolTable
+ 70
+2
+  0
+BLOCK_RECORD
+  5
+1F
+330
+1
+100
+AcDbSymbolTableRecord
+100
+AcDbBlockTableRecord
+  2
+*Model_Space
+ 70
+0
+280
+1
+281
+0
+  0
+BLOCK_RECORD
+  5
+1E
+330
+1
+100
+AcDbSymbolTableRecord
+100
+AcDbBlockTableRecord
+  2
+*Paper_Space
+ 70
+0
+280
+1
+281
+0
+  0
+ENDTAB
+  0
+ENDSEC
+  0
+SECTION
+  2
+BLOCKS
+  0
+BLOCK
+  5
+20
+330
+1F
+100
+AcDbEntity
+  8
+0
+100
+AcDbBlockBegin
+  2
+*Model_Space
+ 70
+0
+ 10
+0
+ 20
+0
+ 30
+0
+  3
+*Model_Space
+  1
+
+  0
+ENDBLK
+  5
+21
+330
+1F
+100
+AcDbEntity
+  8
+0
+100
+AcDbBlockEnd
+  0
+BLOCK
+  5
+1C
+330
+1E
+100
+AcDbEntity
+  8
+0
+100
+AcDbBlockBegin
+  2
+*Paper_Space
+ 70
+0
+ 10
+0
+ 20
+0
+ 30
+0
+  3
+*Paper_Space
+  1
+
+  0
+ENDBLK
+  5
+1D
+330
+1E
+100
+AcDbEntity
+  8
+0
+100
+AcDbBlockEnd
+  0
+ENDSEC
+)"};
+
+    constexpr auto OBJECTS = std::string_view{R"(  0
+SECTION
+  2
+OBJECTS
+  0
+DICTIONARY
+  5
+C
+330
+0
+100
+AcDbDictionary
+281
+1
+  3
+ACAD_GROUP
+350
+D
+  0
+DICTIONARY
+  5
+D
+330
+C
+100
+AcDbDictionary
+281
+1
+  0
+ENDSEC
+  0
+EOF
+)"};
+
+    // Groups of a dxf file, formatted into a buffer written out whenever it fills up
+    class GroupWriter
+    {
+      public:
+        explicit GroupWriter(const std::filesystem::path& filePath) : filePath_{filePath}, out_{filePath, std::ios::binary}
+        {
+            if (!out_)
+                throw std::runtime_error{fmt::format("unable to write file {}", filePath.string())};
+        }
+
+        void writeString(int code, std::string_view value) { format("{:>3}\n{}\n", code, value); }
+        void writeInt(int code, std::int64_t value) { format("{:>3}\n{}\n", code, value); }
+        void writeDouble(int code, double value) { format("{:>3}\n{}\n", code, value); }
+        void writeHandle(int code, std::uint64_t handle) { format("{:>3}\n{:X}\n", code, handle); }
+
+        // z is left out when null, readers defaulting it to 0
+        void writeCoord(int code, const DxfCoord& coord)
+        {
+            writeDouble(code, coord.x);
+            writeDouble(code + 10, coord.y);
+            if (coord.z != 0.)
+                writeDouble(code + 20, coord.z);
+        }
+
+        // Already formatted groups
+        void writeGroups(std::string_view groups)
+        {
+            buffer_.append(groups);
+            flushIfFull();
+        }
+
+        void close()
+        {
+            flush();
+            out_.close();
+            if (!out_)
+                throw std::runtime_error{fmt::format("unable to write file {}", filePath_.string())};
+        }
+
+      private:
+        template<typename... Args> void format(fmt::format_string<Args...> format, Args&&... args)
+        {
+            fmt::format_to(std::back_inserter(buffer_), format, std::forward<Args>(args)...);
+            flushIfFull();
+        }
+
+        void flushIfFull()
+        {
+            if (buffer_.size() >= BUFFER_SIZE)
+                flush();
+        }
+
+        void flush()
+        {
+            out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+            buffer_.clear();
+        }
+
+        std::filesystem::path filePath_;
+        std::ofstream         out_;
+        fmt::memory_buffer    buffer_;
+    };
+
+    void writeTableBegin(GroupWriter& writer, std::string_view name, std::uint64_t handle, std::uint64_t entryCount)
+    {
+        writer.writeString(0, "TABLE");
+        writer.writeString(2, name);
+        writer.writeHandle(5, handle);
+        writer.writeHandle(330, 0);
+        writer.writeString(100, "AcDbSymbolTable");
+        writer.writeInt(70, static_cast<std::int64_t>(entryCount));
+    }
+
+    void writeLayer(GroupWriter& writer, std::string_view name, std::int64_t color, std::uint64_t handle)
+    {
+        writer.writeString(0, "LAYER");
+        writer.writeHandle(5, handle);
+        writer.writeHandle(330, LAYER_TABLE_HANDLE);
+        writer.writeString(100, "AcDbSymbolTableRecord");
+        writer.writeString(100, "AcDbLayerTableRecord");
+        writer.writeString(2, name);
+        writer.writeInt(70, 0);
+        writer.writeInt(62, color);
+        writer.writeString(6, "CONTINUOUS");
+        writer.writeInt(370, -3);
+    }
+
+    // Layer 0 must exist, it is added after the model ones as libdxfrw does when the model has none
+    void writeLayerTable(GroupWriter& writer, const std::vector<DxfLayer>& layers, const std::vector<std::uint64_t>& layerHandles)
+    {
+        const auto hasLayer0 = std::find(layerHandles.begin(), layerHandles.end(), LAYER_0_HANDLE) != layerHandles.end();
+        writeTableBegin(writer, "LAYER", LAYER_TABLE_HANDLE, layers.size() + (hasLayer0 ? 0 : 1));
+        for (std::uint64_t i = 0, n = layers.size(); i < n; ++i)
+            writeLayer(writer, layers[i].name, layers[i].color, layerHandles[i]);
+        if (!hasLayer0)
+            writeLayer(writer, "0", 7, LAYER_0_HANDLE);
+        writer.writeString(0, "ENDTAB");
+    }
+
+    void writeAppId(GroupWriter& writer, std::string_view name, std::uint64_t handle)
+    {
+        writer.writeString(0, "APPID");
+        writer.writeHandle(5, handle);
+        writer.writeHandle(330, APPID_TABLE_HANDLE);
+        writer.writeString(100, "AcDbSymbolTableRecord");
+        writer.writeString(100, "AcDbRegAppTableRecord");
+        writer.writeString(2, name);
+        writer.writeInt(70, 0);
+    }
+
+    void writeAppIdTable(GroupWriter& writer, std::uint64_t peURLHandle)
+    {
+        writeTableBegin(writer, "APPID", APPID_TABLE_HANDLE, 2);
+        writeAppId(writer, "ACAD", ACAD_APPID_HANDLE);
+        writeAppId(writer, "PE_URL", peURLHandle);
+        writer.writeString(0, "ENDTAB");
+    }
+
+    // Entities belong to the model space, colors being ByLayer when not written
+    void writeEntityBegin(GroupWriter& writer, std::string_view type, const DxfEntity& entity, std::uint64_t handle)
+    {
+        writer.writeString(0, type);
+        writer.writeHandle(5, handle);
+        writer.writeHandle(330, MODEL_SPACE_HANDLE);
+        writer.writeString(100, "AcDbEntity");
+        writer.writeString(8, entity.layer);
+        if (entity.color)
+            writer.writeInt(62, *entity.color);
+    }
+
+    // Extended data ends the entity
+    void writeEntityEnd(GroupWriter& writer, const DxfEntity& entity)
+    {
+        if (!entity.peURL)
+            return;
+        writer.writeString(1001, "PE_URL");
+        writer.writeString(1000, *entity.peURL);
+    }
+
+    void writeLine(GroupWriter& writer, const DxfLine& line, std::uint64_t handle)
+    {
+        writeEntityBegin(writer, "LINE", line, handle);
+        writer.writeString(100, "AcDbLine");
+        writer.writeCoord(10, line.p1);
+        writer.writeCoord(11, line.p2);
+        writeEntityEnd(writer, line);
+    }
+
+    // Angles are written in degrees
+    void writeArc(GroupWriter& writer, const DxfArc& arc, std::uint64_t handle)
+    {
+        writeEntityBegin(writer, "ARC", arc, handle);
+        writer.writeString(100, "AcDbCircle");
+        writer.writeCoord(10, arc.center);
+        writer.writeDouble(40, arc.radius);
+        writer.writeString(100, "AcDbArc");
+        writer.writeDouble(50, arc.theta1 * DEGREES_PER_RADIAN);
+        writer.writeDouble(51, arc.theta2 * DEGREES_PER_RADIAN);
+        writeEntityEnd(writer, arc);
+    }
+
+    // Vertices only have x and y, the elevation of the polyline being the z of its last vertex. Null bulges are left out.
+    void writePolyline(GroupWriter& writer, const DxfPolyline& polyline, std::uint64_t handle)
+    {
+        const auto& coords = polyline.coords;
+        writeEntityBegin(writer, "LWPOLYLINE", polyline.entity, handle);
+        writer.writeString(100, "AcDbPolyline");
+        writer.writeInt(90, static_cast<std::int64_t>(coords.size()));
+        writer.writeInt(70, polyline.closed ? 1 : 0);
+        if (!coords.empty() && coords[coords.size() - 1].z != 0.)
+            writer.writeDouble(38, coords[coords.size() - 1].z);
+        for (std::uint64_t i = 0, n = coords.size(); i < n; ++i) {
+            writer.writeDouble(10, coords[i].x);
+            writer.writeDouble(20, coords[i].y);
+            if (polyline.bulges && (*polyline.bulges)[i] != 0.)
+                writer.writeDouble(42, (*polyline.bulges)[i]);
+        }
+        writeEntityEnd(writer, polyline.entity);
+    }
+}
+
+void writeDxfAscii(const DxfModel& model, const std::filesystem::path& filePath)
+{
+    // The first layer 0 takes the handle the constant sections expect, other layers, the PE_URL application and entities the free ones
+    auto layerHandles = std::vector<std::uint64_t>{};
+    auto nextHandle   = FIRST_FREE_HANDLE;
+    for (const auto& layer : model.layers) {
+        const auto isFirstLayer0 = layer.name == "0" && std::find(layerHandles.begin(), layerHandles.end(), LAYER_0_HANDLE) == layerHandles.end();
+        layerHandles.push_back(isFirstLayer0 ? LAYER_0_HANDLE : nextHandle++);
+    }
+    const auto peURLHandle = nextHandle++;
+    const auto handleSeed  = nextHandle + model.lines.size() + model.arcs.size() + model.polylines.size();
+
+    auto writer = GroupWriter{filePath};
+    writer.writeGroups(HEADER);
+    writer.writeHandle(5, handleSeed);
+    writer.writeGroups(HEADER_END_AND_CLASSES);
+
+    writer.writeGroups(VPORT_AND_LTYPE_TABLES);
+    writeLayerTable(writer, model.layers, layerHandles);
+    writer.writeGroups(STYLE_VIEW_AND_UCS_TABLES);
+    writeAppIdTable(writer, peURLHandle);
+    writer.writeGroups(DIMSTYLE_AND_BLOCK_RECORD_TABLES_AND_BLOCKS);
+
+    writer.writeString(0, "SECTION");
+    writer.writeString(2, "ENTITIES");
+    for (const auto& line : model.lines)
+        writeLine(writer, line, nextHandle++);
+    for (const auto& arc : model.arcs)
+        writeArc(writer, arc, nextHandle++);
+    for (std::uint64_t i = 0, n = model.polylines.size(); i < n; ++i)
+        writePolyline(writer, model.polylines[i], nextHandle++);
+    writer.writeString(0, "ENDSEC");
+
+    writer.writeGroups(OBJECTS);
+    writer.close();
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <filesystem>
+
+struct DxfModel;
+
+// Writes an AutoCAD 2013 ASCII dxf file straight from the model, group codes being formatted into a buffer flushed to the file
+// as it fills up. The tables and objects every reader expects are those libdxfrw writes by default, the layer and application
+// tables being filled from the model.
+void writeDxfAscii(const DxfModel& model, const std::filesystem::path& filePath);
\ No newline at end of file
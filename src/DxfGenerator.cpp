@@ -0,0 +1,166 @@
+#include "DxfGenerator.h"
+
+#include "Dxf2Jeo.h"
+#include "DxfModel.h"
+#include "DxfWriter.h"
+#include "JeoModel.h"
+#include "JeoWriter.h"
+#include <algorithm>
+#include <cmath>
+#include <fmt/format.h>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+    static const auto PI = std::atan(1.) * 4;
+
+    class Generator
+    {
+      public:
+        explicit Generator(const DxfGeneratorOptions& options) : options_{options}, random_{options.seed} {}
+
+        DxfModel generate()
+        {
+            auto dxfModel = DxfModel{};
+            for (auto i = std::uint64_t{0}; i < options_.layerCount; ++i)
+                dxfModel.layers.push_back(DxfLayer{fmt::format("layer_{}", i), static_cast<std::int64_t>(1 + i % 255)});
+            layers_ = &dxfModel.layers;
+
+            dxfModel.lines.reserve(options_.lineCount);
+            for (auto i = std::uint64_t{0}; i < options_.lineCount; ++i)
+                dxfModel.lines.push_back(generateLine());
+
+            dxfModel.arcs.reserve(options_.arcCount);
+            for (auto i = std::uint64_t{0}; i < options_.arcCount; ++i)
+                dxfModel.arcs.push_back(generateArc());
+
+            dxfModel.polylines.reserve(options_.polylineCount, options_.polylineCount * options_.vertexCount);
+            for (auto i = std::uint64_t{0}; i < options_.polylineCount; ++i)
+                generatePolyline(dxfModel.polylines);
+
+            layers_ = nullptr;
+            return dxfModel;
+        }
+
+      private:
+        // Values are derived from the raw output of the engine, which the standard specifies, rather than through standard
+        // distributions, whose algorithms are left to each library
+
+        // Uniform in [0, 1), from the 53 high bits of an output
+        double drawUnit() { return static_cast<double>(random_() >> 11) * 0x1p-53; }
+
+        bool draw(double probability) { return drawUnit() < probability; }
+
+        // Uniform in [0, count), outputs below 2^64 mod count being rejected so that every index is as likely
+        std::uint64_t drawIndex(std::uint64_t count)
+        {
+            const auto threshold = (0 - count) % count;
+            for (;;)
+                if (const auto value = random_(); value >= threshold)
+                    return value % count;
+        }
+
+        double drawReal(double min, double max) { return min + (max - min) * drawUnit(); }
+
+        DxfCoord generatePoint()
+        {
+            if (!points_.empty() && draw(options_.sharedPointRatio))
+                return points_[drawIndex(points_.size())];
+
+            const auto point = DxfCoord{drawReal(0., options_.spread), drawReal(0., options_.spread), 0.};
+            points_.push_back(point);
+            return point;
+        }
+
+        void generateEntity(DxfEntity& entity)
+        {
+            entity.layer = (*layers_)[drawIndex(layers_->size())].name;
+            if (options_.colorCount != 0)
+                entity.color = static_cast<std::int64_t>(1 + drawIndex(options_.colorCount));
+            if (options_.tagCount != 0 && draw(options_.tagRatio))
+                entity.peURL = fmt::format("tag_{}", drawIndex(options_.tagCount));
+        }
+
+        DxfLine generateLine()
+        {
+            auto line = DxfLine{};
+            generateEntity(line);
+            line.p1 = generatePoint();
+            line.p2 = generatePoint();
+            return line;
+        }
+
+        // Arc ends follow from their center, radius and angles, only centers may be shared
+        DxfArc generateArc()
+        {
+            auto arc = DxfArc{};
+            generateEntity(arc);
+            arc.center = generatePoint();
+            arc.radius = drawReal(0.001, 0.1) * options_.spread;
+            arc.theta1 = drawReal(0., 2 * PI);
+            arc.theta2 = arc.theta1 + drawReal(0.1, 2 * PI - 0.1);
+            return arc;
+        }
+
+        void generatePolyline(DxfPolylines& polylines)
+        {
+            auto entity = DxfPolylineEntity{};
+            generateEntity(entity);
+            entity.closed = draw(0.5);
+            for (auto i = std::uint64_t{0}; i < options_.vertexCount; ++i)
+                polylines.coords.push_back(generatePoint());
+            polylines.coordOffsets.push_back(polylines.coords.size());
+
+            const auto bulgesBegin = polylines.bulges.size();
+            polylines.bulges.resize(bulgesBegin + options_.vertexCount, 0.);
+            for (auto i = bulgesBegin, n = polylines.bulges.size(); i < n; ++i)
+                if (draw(options_.bulgeRatio))
+                    polylines.bulges[i] = drawReal(-1., 1.);
+            entity.hasBulges = std::any_of(polylines.bulges.begin() + bulgesBegin, polylines.bulges.end(), [](double bulge) { return bulge != 0.; });
+            if (!entity.hasBulges)
+                polylines.bulges.resize(bulgesBegin);
+            polylines.bulgeOffsets.push_back(polylines.bulges.size());
+            polylines.entities.push_back(std::move(entity));
+        }
+
+        DxfGeneratorOptions          options_;
+        std::mt19937_64              random_;
+        const std::vector<DxfLayer>* layers_ = nullptr;
+        std::vector<DxfCoord>        points_;
+    };
+
+    void checkOptions(const DxfGeneratorOptions& options)
+    {
+        if (options.vertexCount < 2)
+            throw std::runtime_error{"polylines need at least 2 vertices"};
+        if (options.layerCount == 0)
+            throw std::runtime_error{"at least 1 layer is needed"};
+        if (options.colorCount > 255)
+            throw std::runtime_error{"at most 255 colors are available"};
+        if (!(options.spread > 0.))
+            throw std::runtime_error{"coordinate spread must be positive"};
+
+        for (const auto ratio : {options.sharedPointRatio, options.bulgeRatio, options.tagRatio})
+            if (!(ratio >= 0. && ratio <= 1.))
+                throw std::runtime_error{fmt::format("ratio {} is not within [0, 1]", ratio)};
+    }
+}
+
+DxfModel generateDxfModel(const DxfGeneratorOptions& options)
+{
+    checkOptions(options);
+    return Generator{options}.generate();
+}
+
+void generateFile(const DxfGeneratorOptions& options, const std::filesystem::path& filePath)
+{
+    const auto extension = filePath.extension();
+    if (extension == ".dxf")
+        writeDxf(generateDxfModel(options), filePath);
+    else if (extension == ".jeo" || extension == ".jeob")
+        writeJeo(convertToJeo(generateDxfModel(options)), filePath);
+    else
+        throw std::runtime_error{fmt::format("unsupported output file extension: {}", extension.string())};
+}
\ No newline at end of file
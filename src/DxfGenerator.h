@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+struct DxfModel;
+
+// Shape of a synthetic drawing. Two generations with the same options are identical, whatever the platform and standard library.
+struct DxfGeneratorOptions
+{
+    std::uint64_t seed          = 0;
+    std::uint64_t lineCount     = 1000;
+    std::uint64_t arcCount      = 1000;
+    std::uint64_t polylineCount = 1000;
+    std::uint64_t vertexCount   = 16; // Vertices of each polyline, at least 2
+
+    double sharedPointRatio = 0.5;  // Probability that a line end, an arc center or a polyline vertex reuses an already generated point
+    double bulgeRatio       = 0.25; // Probability that a polyline vertex has a non zero bulge
+    double spread           = 1000; // Coordinates are drawn within [0, spread] x [0, spread]
+
+    std::uint64_t layerCount = 8;   // At least 1, each layer having its own color
+    std::uint64_t colorCount = 0;   // Distinct explicit entity colors, up to 255, entities being ByLayer when 0
+    std::uint64_t tagCount   = 0;   // Distinct PE_URL tags, entities having none when 0
+    double        tagRatio   = 1.0; // Probability that an entity has a tag, when tagCount is not 0
+};
+
+DxfModel generateDxfModel(const DxfGeneratorOptions& options);
+
+// Generates the dxf model and writes it, as a .dxf file or converted into a .jeo or .jeob file
+void generateFile(const DxfGeneratorOptions& options, const std::filesystem::path& filePath);
\ No newline at end of file
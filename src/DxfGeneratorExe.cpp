@@ -0,0 +1,103 @@
+#include "Dxf2JeoVersion.h"
+#include "DxfGenerator.h"
+#include <cxxopts.hpp>
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+#include <iostream>
+
+namespace {
+    auto getCLOptions()
+    {
+        auto options = cxxopts::Options{"dxfgenerator", "Generates a synthetic 2D .dxf, .jeo or .jeob file of any size"};
+        options.add_options()                                                                                                                      //
+            ("o,output", "Output file path (.dxf, .jeo or .jeob)", cxxopts::value<std::string>())                                                  //
+            ("seed", "Random seed", cxxopts::value<std::uint64_t>()->default_value("0"))                                                           //
+            ("lines", "Number of lines", cxxopts::value<std::uint64_t>()->default_value("1000"))                                                   //
+            ("arcs", "Number of arcs", cxxopts::value<std::uint64_t>()->default_value("1000"))                                                     //
+            ("polylines", "Number of polylines", cxxopts::value<std::uint64_t>()->default_value("1000"))                                           //
+            ("vertices", "Vertices of each polyline", cxxopts::value<std::uint64_t>()->default_value("16"))                                        //
+            ("shared-points", "Probability that a point reuses an already generated one", cxxopts::value<double>()->default_value("0.5"))          //
+            ("bulges", "Probability that a polyline vertex has a bulge", cxxopts::value<double>()->default_value("0.25"))                          //
+            ("spread", "Coordinates are drawn within [0, spread] x [0, spread]", cxxopts::value<double>()->default_value("1000"))                  //
+            ("layers", "Number of layers", cxxopts::value<std::uint64_t>()->default_value("8"))                                                    //
+            ("colors", "Number of explicit entity colors, up to 255, 0 for ByLayer entities", cxxopts::value<std::uint64_t>()->default_value("0")) //
+            ("tags", "Number of distinct PE_URL tags, 0 for none", cxxopts::value<std::uint64_t>()->default_value("0"))                            //
+            ("tag-ratio", "Probability that an entity has a tag", cxxopts::value<double>()->default_value("1"))                                    //
+            ("v,version", "Display dxfgenerator version")                                                                                          //
+            ("h,help", "Display this help");
+        return options;
+    }
+
+    int help()
+    {
+        fmt::print(std::cout, "{}\n", getCLOptions().help());
+        return 0;
+    }
+
+    int version()
+    {
+        fmt::print(std::cout, "dxfgenerator version {}.{}.{}\n", DXF2JEO_VERSION_MAJOR, DXF2JEO_VERSION_MINOR, DXF2JEO_VERSION_PATCH);
+        return 0;
+    }
+
+    template<typename... Args> int error(std::string_view fmt, Args&&... args)
+    {
+        fmt::print(std::cerr, fmt::runtime(fmt::format("Error: {}\n", fmt)), std::forward<Args>(args)...);
+        fmt::print("---------------------------------------\n");
+        fmt::print(std::cerr, "{}\n", getCLOptions().help());
+        return -1;
+    }
+
+    int run(int argc, char** argv)
+    {
+        try {
+            const auto result = getCLOptions().parse(argc, argv);
+
+            if (result.count("help"))
+                return help();
+
+            if (result.count("version"))
+                return version();
+
+            if (result.count("output") == 0)
+                return error("output file path must be provided");
+
+            auto options             = DxfGeneratorOptions{};
+            options.seed             = result["seed"].as<std::uint64_t>();
+            options.lineCount        = result["lines"].as<std::uint64_t>();
+            options.arcCount         = result["arcs"].as<std::uint64_t>();
+            options.polylineCount    = result["polylines"].as<std::uint64_t>();
+            options.vertexCount      = result["vertices"].as<std::uint64_t>();
+            options.sharedPointRatio = result["shared-points"].as<double>();
+            options.bulgeRatio       = result["bulges"].as<double>();
+            options.spread           = result["spread"].as<double>();
+            options.layerCount       = result["layers"].as<std::uint64_t>();
+            options.colorCount       = result["colors"].as<std::uint64_t>();
+            options.tagCount         = result["tags"].as<std::uint64_t>();
+            options.tagRatio         = result["tag-ratio"].as<double>();
+
+            const auto outputPath = std::filesystem::path{result["output"].as<std::string>()};
+            create_directories(outputPath.parent_path());
+            generateFile(options, outputPath);
+
+            return 0;
+        }
+        catch (const std::exception& e) {
+            return error(e.what());
+        }
+        catch (...) {
+            return error("unknown exception");
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    try {
+        run(argc, argv);
+        return 0;
+    }
+    catch (...) {
+        return -1;
+    }
+}
\ No newline at end of file
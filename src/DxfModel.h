@@ -1,7 +1,9 @@
 #pragma once
 
+#include "ArrayView.h"
 #include <cstdint>
 #include <optional>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -39,11 +41,87 @@ struct DxfArc : DxfEntity
     double   theta2 = 0;
 };
 
-struct DxfPolyline : DxfEntity
+// Polyline as read from DxfPolylines or passed to a DxfEntitySink, viewing its entity, vertices and bulges where they are stored
+struct DxfPolyline
 {
-    std::vector<DxfCoord>              coords;
-    std::optional<std::vector<double>> bulges;
-    bool                               closed = false;
+    const DxfEntity&                 entity;
+    ArrayView<DxfCoord>              coords;
+    std::optional<ArrayView<double>> bulges;
+    bool                             closed = false;
+};
+
+// Per polyline part of DxfPolylines
+struct DxfPolylineEntity : DxfEntity
+{
+    bool closed    = false;
+    bool hasBulges = false;
+};
+
+// Vertices and bulges of all polylines stored back to back, as JeoPolylines does: polyline i owns coords[coordOffsets[i],
+// coordOffsets[i + 1]) and bulges[bulgeOffsets[i], bulgeOffsets[i + 1]), the latter range being empty unless the polyline
+// has bulges. The offsets hold one more value than there are polylines.
+struct DxfPolylines
+{
+    std::vector<DxfPolylineEntity> entities;
+    std::vector<std::uint64_t>     coordOffsets = {0};
+    std::vector<DxfCoord>          coords;
+    std::vector<std::uint64_t>     bulgeOffsets = {0};
+    std::vector<double>            bulges;
+
+    std::uint64_t size() const { return entities.size(); }
+    bool          empty() const { return entities.empty(); }
+
+    DxfPolyline operator[](std::uint64_t i) const
+    {
+        const auto& entity         = entities[i];
+        const auto  polylineCoords = ArrayView<DxfCoord>{coords.data() + coordOffsets[i], coordOffsets[i + 1] - coordOffsets[i]};
+        auto        polylineBulges = std::optional<ArrayView<double>>{};
+        if (entity.hasBulges)
+            polylineBulges = ArrayView<double>{bulges.data() + bulgeOffsets[i], bulgeOffsets[i + 1] - bulgeOffsets[i]};
+        return {entity, polylineCoords, polylineBulges, entity.closed};
+    }
+
+    DxfPolyline at(std::uint64_t i) const
+    {
+        if (i >= size())
+            throw std::out_of_range{"polyline index out of range"};
+        return (*this)[i];
+    }
+
+    void push_back(const DxfPolyline& polyline)
+    {
+        auto entity      = DxfPolylineEntity{polyline.entity};
+        entity.closed    = polyline.closed;
+        entity.hasBulges = polyline.bulges.has_value();
+        entities.push_back(std::move(entity));
+        coords.insert(coords.end(), polyline.coords.begin(), polyline.coords.end());
+        coordOffsets.push_back(coords.size());
+        if (polyline.bulges)
+            bulges.insert(bulges.end(), polyline.bulges->begin(), polyline.bulges->end());
+        bulgeOffsets.push_back(bulges.size());
+    }
+
+    // Appends the polylines of other after these ones
+    void append(const DxfPolylines& other)
+    {
+        const auto coordBase = coords.size();
+        const auto bulgeBase = bulges.size();
+        entities.insert(entities.end(), other.entities.begin(), other.entities.end());
+        coords.insert(coords.end(), other.coords.begin(), other.coords.end());
+        bulges.insert(bulges.end(), other.bulges.begin(), other.bulges.end());
+        for (std::uint64_t i = 1, n = other.coordOffsets.size(); i < n; ++i)
+            coordOffsets.push_back(coordBase + other.coordOffsets[i]);
+        for (std::uint64_t i = 1, n = other.bulgeOffsets.size(); i < n; ++i)
+            bulgeOffsets.push_back(bulgeBase + other.bulgeOffsets[i]);
+    }
+
+    void reserve(std::uint64_t polylineCount, std::uint64_t vertexCount)
+    {
+        entities.reserve(polylineCount);
+        coordOffsets.reserve(polylineCount + 1);
+        bulgeOffsets.reserve(polylineCount + 1);
+        coords.reserve(vertexCount);
+    }
 };
 
 struct DxfModel
@@ -51,5 +129,5 @@ struct DxfModel
     std::vector<DxfLayer>    layers;
     std::vector<DxfLine>     lines;
     std::vector<DxfArc>      arcs;
-    std::vector<DxfPolyline> polylines;
+    DxfPolylines             polylines;
 };
\ No newline at end of file
@@ -1,11 +1,14 @@
 #include "DxfReader.h"
 
 #include "ArcUtils.h"
+#include "DxfAsciiReader.h"
 #include "DxfModel.h"
+#include "InputFile.h"
 #include <algorithm>
 #include <cmath>
 #include <fmt/format.h>
 #include <libdxfrw/libdxfrw.h>
+#include <unordered_map>
 
 namespace {
 
@@ -70,23 +73,40 @@ namespace {
         return arc;
     }
 
-    DxfPolyline convertPolyline(const DRW_LWPolyline& data)
+    // Appends the vertices of the polyline to coords and their bulges to bulges, the latter being taken back when all of them are null.
+    // Returns whether the bulges were kept.
+    bool appendVertices(const DRW_LWPolyline& data, std::vector<DxfCoord>& coords, std::vector<double>& bulges)
     {
-        auto polyline = DxfPolyline{convertEntity(data)};
-        auto bulges   = std::vector<double>{};
+        const auto bulgesBegin = bulges.size();
         for (auto i = 0; i < data.vertexnum; ++i) {
             auto coord = DxfCoord{};
             coord.x    = data.vertlist[i]->x;
             coord.y    = data.vertlist[i]->y;
             coord.z    = data.elevation;
-            polyline.coords.push_back(coord);
+            coords.push_back(coord);
             bulges.push_back(data.vertlist[i]->bulge);
         }
-        if (std::any_of(bulges.begin(), bulges.end(), [](double bulge) { return std::fabs(bulge) > std::numeric_limits<double>::epsilon(); }))
-            polyline.bulges = std::move(bulges);
-        polyline.closed = data.flags & 1;
+        const auto isBulge = [](double bulge) { return std::fabs(bulge) > std::numeric_limits<double>::epsilon(); };
+        if (std::any_of(bulges.begin() + bulgesBegin, bulges.end(), isBulge))
+            return true;
+        bulges.resize(bulgesBegin);
+        return false;
+    }
 
-        return polyline;
+    DxfPolylineEntity convertPolylineEntity(const DRW_LWPolyline& data, bool hasBulges)
+    {
+        auto entity      = DxfPolylineEntity{convertEntity(data)};
+        entity.closed    = data.flags & 1;
+        entity.hasBulges = hasBulges;
+        return entity;
+    }
+
+    void addPolyline(DxfPolylines& polylines, const DRW_LWPolyline& data)
+    {
+        const auto hasBulges = appendVertices(data, polylines.coords, polylines.bulges);
+        polylines.entities.push_back(convertPolylineEntity(data, hasBulges));
+        polylines.coordOffsets.push_back(polylines.coords.size());
+        polylines.bulgeOffsets.push_back(polylines.bulges.size());
     }
 
     std::unordered_map<std::string, std::int64_t> makeLayerNameToColorMap(const DxfModel& model)
@@ -107,24 +127,33 @@ namespace {
             return std::nullopt;
     }
 
-    DxfModel checkModel(DxfModel model)
+    void checkModel(DxfModel& model)
     {
         const auto layerNameToColor = makeLayerNameToColorMap(model);
         for (auto& line : model.lines)
             line.color = getColor(line, layerNameToColor);
         for (auto& arc : model.arcs)
             arc.color = getColor(arc, layerNameToColor);
-        for (auto& polyline : model.polylines)
+        for (auto& polyline : model.polylines.entities)
             polyline.color = getColor(polyline, layerNameToColor);
-        return model;
     }
 
-    class DxfReaderInterface : public DRW_Interface
+    // Receives the records of libdxfrw or of the native reader
+    class DxfReaderInterface : public DRW_Interface, public DxfRecordHandler
     {
       public:
+        DxfReaderInterface() = default;
+        explicit DxfReaderInterface(DxfEntitySink& sink) : sink_{&sink} {}
+
         void addHeader(const DRW_Header*) override {}
         void addLType(const DRW_LType&) override {}
-        void addLayer(const DRW_Layer& data) override { model_.layers.push_back(convertLayer(data)); }
+        void addLayer(const DRW_Layer& data) override
+        {
+            if (sink_)
+                layerNameToColor_[data.name] = data.color;
+            else
+                model_.layers.push_back(convertLayer(data));
+        }
         void addDimStyle(const DRW_Dimstyle&) override {}
         void addVport(const DRW_Vport&) override {}
         void addTextStyle(const DRW_Textstyle&) override {}
@@ -133,13 +162,37 @@ namespace {
         void setBlock(const int) override {}
         void endBlock() override {}
         void addPoint(const DRW_Point&) override {}
-        void addLine(const DRW_Line& data) override { model_.lines.push_back(convertLine(data)); }
+        void addLine(const DRW_Line& data) override
+        {
+            if (sink_)
+                sink_->addLine(resolveColor(convertLine(data)));
+            else
+                model_.lines.push_back(convertLine(data));
+        }
         void addRay(const DRW_Ray&) override {}
         void addXline(const DRW_Xline&) override {}
-        void addArc(const DRW_Arc& data) override { model_.arcs.push_back(convertArc(data)); }
+        void addArc(const DRW_Arc& data) override
+        {
+            if (sink_)
+                sink_->addArc(resolveColor(convertArc(data)));
+            else
+                model_.arcs.push_back(convertArc(data));
+        }
         void addCircle(const DRW_Circle&) override {}
         void addEllipse(const DRW_Ellipse&) override {}
-        void addLWPolyline(const DRW_LWPolyline& data) override { model_.polylines.push_back(convertPolyline(data)); }
+        void addLWPolyline(const DRW_LWPolyline& data) override
+        {
+            if (sink_) {
+                // The vertices of each polyline are gathered into the same buffers, only allocated once
+                coords_.clear();
+                bulges_.clear();
+                const auto entity = resolveColor(convertPolylineEntity(data, appendVertices(data, coords_, bulges_)));
+                const auto bulges = entity.hasBulges ? std::optional{ArrayView<double>{bulges_}} : std::nullopt;
+                sink_->addPolyline({entity, coords_, bulges, entity.closed});
+            }
+            else
+                ::addPolyline(model_.polylines, data);
+        }
         void addPolyline(const DRW_Polyline&) override {}
         void addSpline(const DRW_Spline*) override {}
         void addKnot(const DRW_Entity&) override {}
@@ -176,20 +229,82 @@ namespace {
         void writeObjects() override {}
         void writeAppId() override {}
 
-        DxfModel model() const { return checkModel(model_); }
+        // The native reader only goes through the interface when streaming, building models on its own
+        void addLayer(const DxfLayer& layer) override { layerNameToColor_[layer.name] = layer.color; }
+        void addLine(const DxfLine& line) override { sink_->addLine(resolveColor(line)); }
+        void addArc(const DxfArc& arc) override { sink_->addArc(resolveColor(arc)); }
+        void addPolyline(const DxfPolyline& polyline) override
+        {
+            sink_->addPolyline({resolveColor(polyline.entity), polyline.coords, polyline.bulges, polyline.closed});
+        }
+
+        // Colors are resolved in place, the model being moved out of the interface
+        DxfModel takeModel()
+        {
+            checkModel(model_);
+            return std::move(model_);
+        }
 
       private:
-        DxfModel model_;
+        // Layers come with the TABLES section, before any entity
+        template<typename T> T resolveColor(T entity) const
+        {
+            entity.color = getColor(entity, layerNameToColor_);
+            return entity;
+        }
+
+        DxfModel                                      model_;
+        DxfEntitySink*                                sink_ = nullptr;
+        std::unordered_map<std::string, std::int64_t> layerNameToColor_;
+        std::vector<DxfCoord>                         coords_;
+        std::vector<double>                           bulges_;
     };
 }
 
 DxfModel readDxf(const std::filesystem::path& filePath)
 {
+    return readDxf(filePath, DxfReaderKind::Libdxfrw);
+}
+
+DxfModel readDxf(const std::filesystem::path& filePath, DxfReaderKind kind)
+{
+    return readDxf(filePath, kind, 1);
+}
+
+DxfModel readDxf(const std::filesystem::path& filePath, DxfReaderKind kind, std::uint64_t threadCount)
+{
+    // Chunks are read concurrently from different parts of the file
+    if (kind == DxfReaderKind::Native) {
+        const auto inputFile = InputFile{filePath, threadCount > 1 ? InputFileAccess::Random : InputFileAccess::Sequential};
+        auto       model     = readDxfAscii(inputFile.contents(), threadCount);
+        checkModel(model);
+        return model;
+    }
+
+    auto       dxfInterf   = DxfReaderInterface{};
     const auto filePathStr = filePath.string();
+    auto       dxfrw       = dxfRW(filePathStr.c_str());
+    if (!dxfrw.read(&dxfInterf, true))
+        throw std::runtime_error{fmt::format("unable to read file {}", filePath.string())};
+    return dxfInterf.takeModel();
+}
+
+void readDxf(const std::filesystem::path& filePath, DxfEntitySink& sink)
+{
+    readDxf(filePath, sink, DxfReaderKind::Libdxfrw);
+}
 
-    auto dxfInterf = DxfReaderInterface{};
-    auto dxfrw     = dxfRW(filePathStr.c_str());
+void readDxf(const std::filesystem::path& filePath, DxfEntitySink& sink, DxfReaderKind kind)
+{
+    auto dxfInterf = DxfReaderInterface{sink};
+    if (kind == DxfReaderKind::Native) {
+        const auto inputFile = InputFile{filePath, InputFileAccess::Sequential};
+        readDxfAscii(inputFile.contents(), dxfInterf);
+        return;
+    }
+
+    const auto filePathStr = filePath.string();
+    auto       dxfrw       = dxfRW(filePathStr.c_str());
     if (!dxfrw.read(&dxfInterf, true))
         throw std::runtime_error{fmt::format("unable to read file {}", filePath.string())};
-    return dxfInterf.model();
 }
\ No newline at end of file
@@ -1,7 +1,39 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 
+struct DxfArc;
+struct DxfLine;
 struct DxfModel;
+struct DxfPolyline;
 
-DxfModel readDxf(const std::filesystem::path& filePath);
\ No newline at end of file
+// Receives the entities of a dxf file while it is being read, ByLayer colors being already resolved
+class DxfEntitySink
+{
+  public:
+    virtual ~DxfEntitySink() = default;
+
+    virtual void addLine(const DxfLine& line)             = 0;
+    virtual void addArc(const DxfArc& arc)                = 0;
+    virtual void addPolyline(const DxfPolyline& polyline) = 0;
+};
+
+enum class DxfReaderKind
+{
+    Libdxfrw, // Any dxf file libdxfrw reads, binary ones included
+    Native    // ASCII dxf files only, tokenized in place, see readDxfAscii
+};
+
+// Reads the file with libdxfrw
+DxfModel readDxf(const std::filesystem::path& filePath);
+
+DxfModel readDxf(const std::filesystem::path& filePath, DxfReaderKind kind);
+
+// Same as readDxf, the native reader parsing the ENTITIES section on up to threadCount threads. libdxfrw always reads on one.
+DxfModel readDxf(const std::filesystem::path& filePath, DxfReaderKind kind, std::uint64_t threadCount);
+
+// Same as readDxf, the entities being passed to sink as they are read instead of being stored
+void readDxf(const std::filesystem::path& filePath, DxfEntitySink& sink);
+
+void readDxf(const std::filesystem::path& filePath, DxfEntitySink& sink, DxfReaderKind kind);
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "DxfWriter.h"
 
+#include "DxfAsciiWriter.h"
 #include "DxfModel.h"
 #include <fmt/format.h>
 #include <libdxfrw/libdxfrw.h>
@@ -48,7 +49,7 @@ namespace {
 
     DRW_LWPolyline convertPolyline(const DxfPolyline& polyline)
     {
-        auto data = convertEntity<DRW_LWPolyline>(polyline);
+        auto data = convertEntity<DRW_LWPolyline>(polyline.entity);
         data.vertlist.reserve(polyline.coords.size());
         for (uint64_t i = 0, n = polyline.coords.size(); i < n; ++i) {
             const auto&  coord = polyline.coords[i];
@@ -130,8 +131,8 @@ namespace {
                 auto data = convertArc(arc);
                 dxfrw_->writeArc(&data);
             }
-            for (const auto& polyline : model_->polylines) {
-                auto data = convertPolyline(polyline);
+            for (std::uint64_t i = 0, n = model_->polylines.size(); i < n; ++i) {
+                auto data = convertPolyline(model_->polylines[i]);
                 dxfrw_->writeLWPolyline(&data);
             }
         }
@@ -166,6 +167,16 @@ namespace {
 
 void writeDxf(const DxfModel& model, const std::filesystem::path& filePath)
 {
+    writeDxf(model, filePath, DxfWriterKind::Libdxfrw);
+}
+
+void writeDxf(const DxfModel& model, const std::filesystem::path& filePath, DxfWriterKind kind)
+{
+    if (kind == DxfWriterKind::Native) {
+        writeDxfAscii(model, filePath);
+        return;
+    }
+
     const auto filePathStr = filePath.string();
 
     auto dxfrw     = dxfRW(filePathStr.c_str());
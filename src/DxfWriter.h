@@ -4,4 +4,13 @@
 
 struct DxfModel;
 
-void writeDxf(const DxfModel& model, const std::filesystem::path& filePath);
\ No newline at end of file
+enum class DxfWriterKind
+{
+    Native,  // Groups written straight from the model, see writeDxfAscii
+    Libdxfrw // Entities converted to libdxfrw ones, vertex by vertex
+};
+
+// Writes the model with libdxfrw
+void writeDxf(const DxfModel& model, const std::filesystem::path& filePath);
+
+void writeDxf(const DxfModel& model, const std::filesystem::path& filePath, DxfWriterKind kind);
\ No newline at end of file
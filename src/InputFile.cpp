@@ -0,0 +1,112 @@
+#include "InputFile.h"
+
+#include <fmt/format.h>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+InputFile::InputFile(const std::filesystem::path& filePath, InputFileAccess access)
+{
+    if (!map(filePath, access))
+        read(filePath);
+}
+
+#if defined(_WIN32)
+
+InputFile::~InputFile()
+{
+    if (mapping_)
+        UnmapViewOfFile(mapping_);
+}
+
+bool InputFile::map(const std::filesystem::path& filePath, InputFileAccess access)
+{
+    const auto flags = access == InputFileAccess::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL;
+    const auto file  = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    auto fileSize = LARGE_INTEGER{};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    const auto fileMapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!fileMapping)
+        return false;
+
+    mapping_ = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(fileMapping);
+    if (!mapping_)
+        return false;
+
+    data_ = static_cast<const char*>(mapping_);
+    size_ = static_cast<std::size_t>(fileSize.QuadPart);
+    return true;
+}
+
+#else
+
+InputFile::~InputFile()
+{
+    if (mapping_)
+        munmap(mapping_, size_);
+}
+
+bool InputFile::map(const std::filesystem::path& filePath, InputFileAccess access)
+{
+    const auto file = open(filePath.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+
+    // Empty files and special files cannot be mapped, they are read instead
+    struct stat fileStat = {};
+    if (fstat(file, &fileStat) != 0 || !S_ISREG(fileStat.st_mode) || fileStat.st_size == 0) {
+        close(file);
+        return false;
+    }
+
+    const auto fileSize = static_cast<std::size_t>(fileStat.st_size);
+    const auto mapping  = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (mapping == MAP_FAILED)
+        return false;
+
+    if (access == InputFileAccess::Sequential)
+        madvise(mapping, fileSize, MADV_SEQUENTIAL);
+
+    mapping_ = mapping;
+    data_    = static_cast<const char*>(mapping);
+    size_    = fileSize;
+    return true;
+}
+
+#endif
+
+void InputFile::read(const std::filesystem::path& filePath)
+{
+    auto in = std::ifstream{filePath, std::ios::binary};
+    if (!in.is_open())
+        throw std::runtime_error{fmt::format("unable to read file {}", filePath.string())};
+
+    buffer_.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+    if (in.bad())
+        throw std::runtime_error{fmt::format("unable to read file {}", filePath.string())};
+
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+}
\ No newline at end of file
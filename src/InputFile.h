@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+enum class InputFileAccess
+{
+    Random,
+    Sequential
+};
+
+// Read-only contents of a whole file. The file is memory mapped when possible and read into a buffer otherwise.
+// Sequential access lets the system read ahead aggressively and drop pages once they have been parsed.
+class InputFile
+{
+  public:
+    explicit InputFile(const std::filesystem::path& filePath, InputFileAccess access = InputFileAccess::Random);
+    ~InputFile();
+
+    InputFile(const InputFile&)            = delete;
+    InputFile& operator=(const InputFile&) = delete;
+
+    std::string_view contents() const { return {data_, size_}; }
+    bool             isMapped() const { return mapping_ != nullptr; }
+
+  private:
+    bool map(const std::filesystem::path& filePath, InputFileAccess access);
+    void read(const std::filesystem::path& filePath);
+
+    const char*       data_    = nullptr;
+    std::size_t       size_    = 0;
+    void*             mapping_ = nullptr;
+    std::vector<char> buffer_;
+};
\ No newline at end of file
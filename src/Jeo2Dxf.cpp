@@ -1,9 +1,11 @@
 #include "Jeo2Dxf.h"
 
+#include "ArcKernel.h"
 #include "ArcUtils.h"
 #include "DxfColors.h"
 #include "DxfModel.h"
 #include "JeoModel.h"
+#include "Parallel.h"
 #include <algorithm>
 #include <cmath>
 #include <stdexcept>
@@ -12,28 +14,6 @@ namespace {
 
     static const auto PI = std::atan(1.) * 4;
 
-    double evaluateDistance(const JeoPoint& p1, const JeoPoint& p2)
-    { //
-        return std::hypot(p2.x - p1.x, p2.y - p1.y);
-    }
-
-    double evaluateArcRadius(const JeoModel& jeoModel, const JeoArc& jeoArc)
-    {
-        const auto jeoCenter = jeoModel.points[jeoArc.centerIndex];
-        const auto jeoP1     = jeoModel.points[jeoArc.firstPointIndex];
-        const auto jeoP2     = jeoModel.points[jeoArc.lastPointIndex];
-        const auto dist1     = evaluateDistance(jeoCenter, jeoP1);
-        const auto dist2     = evaluateDistance(jeoCenter, jeoP2);
-        return (dist1 + dist2) / 2.;
-    }
-
-    double evaluateArcTheta(const JeoModel& jeoModel, const JeoArc& jeoArc, std::uint64_t pointIndex)
-    {
-        const auto jeoCenter = jeoModel.points[jeoArc.centerIndex];
-        const auto jeoPoint  = jeoModel.points[pointIndex];
-        return std::atan2(jeoPoint.y - jeoCenter.y, jeoPoint.x - jeoCenter.x);
-    }
-
     std::optional<std::uint8_t> toDxfColor(const JeoModel& jeoModel, std::optional<uint64_t> colorIndex)
     {
         if (!colorIndex)
@@ -56,13 +36,6 @@ namespace {
         return {jeoPoint.x, jeoPoint.y, jeoPoint.z};
     }
 
-    std::vector<DxfCoord> toDxfCoords(const JeoModel& jeoModel, const std::vector<std::uint64_t>& pointIndexes)
-    {
-        auto dxfCoords = std::vector<DxfCoord>(pointIndexes.size());
-        std::transform(pointIndexes.begin(), pointIndexes.end(), dxfCoords.begin(), [&](std::uint64_t pointIndex) { return toDxfCoord(jeoModel, pointIndex); });
-        return dxfCoords;
-    }
-
     template<typename DxfEntity> DxfEntity toDxfEntity(const JeoModel& jeoModel, const JeoEntity& jeoEntity)
     {
         auto dxfEntity  = DxfEntity{};
@@ -79,44 +52,102 @@ namespace {
         return dxfLine;
     }
 
-    DxfArc toDxfArc(const JeoModel& jeoModel, const JeoArc& jeoArc)
+    // Offsets of the arc points from their center, read straight from the point arrays as arcs only need x and y
+    void gatherArc(const JeoPoints& points, const JeoArc& jeoArc, ArcBlock& block, std::uint64_t i)
+    {
+        const auto centerX = points.x[jeoArc.centerIndex];
+        const auto centerY = points.y[jeoArc.centerIndex];
+        block.firstDx[i]   = points.x[jeoArc.firstPointIndex] - centerX;
+        block.firstDy[i]   = points.y[jeoArc.firstPointIndex] - centerY;
+        block.lastDx[i]    = points.x[jeoArc.lastPointIndex] - centerX;
+        block.lastDy[i]    = points.y[jeoArc.lastPointIndex] - centerY;
+    }
+
+    DxfArc toDxfArc(const JeoModel& jeoModel, const JeoArc& jeoArc, const ArcBlock& block, std::uint64_t i)
     {
         auto dxfArc   = toDxfEntity<DxfArc>(jeoModel, jeoArc);
         dxfArc.center = toDxfCoord(jeoModel, jeoArc.centerIndex);
-        dxfArc.radius = evaluateArcRadius(jeoModel, jeoArc);
-        if (jeoArc.firstPointIndex == jeoArc.lastPointIndex) {
-            dxfArc.theta1 = evaluateArcTheta(jeoModel, jeoArc, jeoArc.firstPointIndex);
+        dxfArc.radius = block.radius[i];
+        dxfArc.theta1 = block.theta1[i];
+        if (jeoArc.firstPointIndex == jeoArc.lastPointIndex)
             dxfArc.theta2 = jeoArc.direct ? dxfArc.theta1 + 2 * PI : dxfArc.theta1;
-        }
         else {
-            dxfArc.theta1 = evaluateArcTheta(jeoModel, jeoArc, jeoArc.firstPointIndex);
-            dxfArc.theta2 = evaluateArcTheta(jeoModel, jeoArc, jeoArc.lastPointIndex);
+            dxfArc.theta2 = block.theta2[i];
             normalize(dxfArc.theta1, dxfArc.theta2, jeoArc.direct);
         }
         return dxfArc;
     }
 
-    DxfPolyline toDxfPolyline(const JeoModel& jeoModel, const JeoPolyline& jeoPolyline)
+    // Radiuses and angles are evaluated a block of arcs at a time by the fastest arc kernel
+    void setDxfArcs(const JeoModel& jeoModel, std::uint64_t begin, std::uint64_t end, std::vector<DxfArc>& dxfArcs)
     {
-        if (jeoPolyline.pointIndexes.size() < 2)
-            throw std::runtime_error{"unsupported polyline"};
-
-        auto dxfPolyline   = toDxfEntity<DxfPolyline>(jeoModel, jeoPolyline);
-        dxfPolyline.coords = toDxfCoords(jeoModel, jeoPolyline.pointIndexes);
-        dxfPolyline.bulges = jeoPolyline.bulges;
-        dxfPolyline.closed = jeoPolyline.closed;
-        return dxfPolyline;
+        const auto kernel = getBestArcKernel();
+        auto       block  = ArcBlock{};
+        for (auto blockBegin = begin; blockBegin < end; blockBegin += ARC_BLOCK_SIZE) {
+            block.size = std::min(ARC_BLOCK_SIZE, end - blockBegin);
+            for (std::uint64_t i = 0; i < block.size; ++i)
+                gatherArc(jeoModel.points, jeoModel.arcs[blockBegin + i], block, i);
+            evaluateArcs(kernel, block);
+            for (std::uint64_t i = 0; i < block.size; ++i)
+                dxfArcs[blockBegin + i] = toDxfArc(jeoModel, jeoModel.arcs[blockBegin + i], block, i);
+        }
+    }
+
+    void setDxfPolylineEntities(const JeoModel& jeoModel, std::uint64_t begin, std::uint64_t end, DxfPolylines& dxfPolylines)
+    {
+        const auto& jeoPolylines = jeoModel.polylines;
+        for (auto i = begin; i < end; ++i) {
+            if (jeoPolylines.pointOffsets[i + 1] - jeoPolylines.pointOffsets[i] < 2)
+                throw std::runtime_error{"unsupported polyline"};
+
+            const auto& jeoEntity = jeoPolylines.entities[i];
+            auto&       dxfEntity = dxfPolylines.entities[i];
+            dxfEntity             = toDxfEntity<DxfPolylineEntity>(jeoModel, jeoEntity);
+            dxfEntity.closed      = jeoEntity.closed;
+            dxfEntity.hasBulges   = jeoEntity.hasBulges;
+        }
     }
 }
 
 DxfModel convertToDxf(const JeoModel& jeoModel)
+{ //
+    return convertToDxf(jeoModel, 1);
+}
+
+DxfModel convertToDxf(const JeoModel& jeoModel, std::uint64_t threadCount)
 {
+    const auto& jeoLines     = jeoModel.lines;
+    const auto& jeoPolylines = jeoModel.polylines;
+
+    // Every entity converts on its own, each thread filling its range of the presized outputs
     auto dxfModel = DxfModel{};
-    for (const auto& line : jeoModel.lines)
-        dxfModel.lines.push_back(toDxfLine(jeoModel, line));
-    for (const auto& arc : jeoModel.arcs)
-        dxfModel.arcs.push_back(toDxfArc(jeoModel, arc));
-    for (const auto& polyline : jeoModel.polylines)
-        dxfModel.polylines.push_back(toDxfPolyline(jeoModel, polyline));
+    dxfModel.lines.resize(jeoLines.size());
+    parallelFor(jeoLines.size(), threadCount, [&](std::uint64_t begin, std::uint64_t end) {
+        for (auto i = begin; i < end; ++i)
+            dxfModel.lines[i] = toDxfLine(jeoModel, jeoLines[i]);
+    });
+
+    // Threads get whole arc blocks, an arc evaluated by the vector part of a kernel rather than its scalar tail being a few ulps away
+    const auto arcCount   = jeoModel.arcs.size();
+    const auto blockCount = (arcCount + ARC_BLOCK_SIZE - 1) / ARC_BLOCK_SIZE;
+    dxfModel.arcs.resize(arcCount);
+    parallelFor(blockCount, threadCount, [&](std::uint64_t begin, std::uint64_t end) {
+        setDxfArcs(jeoModel, begin * ARC_BLOCK_SIZE, std::min(end * ARC_BLOCK_SIZE, arcCount), dxfModel.arcs);
+    });
+
+    // Both models lay polylines out the same way, one coordinate standing for each point index
+    auto& dxfPolylines        = dxfModel.polylines;
+    dxfPolylines.coordOffsets = jeoPolylines.pointOffsets;
+    dxfPolylines.bulgeOffsets = jeoPolylines.bulgeOffsets;
+    dxfPolylines.bulges       = jeoPolylines.bulges;
+    dxfPolylines.entities.resize(jeoPolylines.size());
+    parallelFor(jeoPolylines.size(), threadCount, [&](std::uint64_t begin, std::uint64_t end) {
+        setDxfPolylineEntities(jeoModel, begin, end, dxfPolylines);
+    });
+    dxfPolylines.coords.resize(jeoPolylines.pointIndexes.size());
+    parallelFor(jeoPolylines.pointIndexes.size(), threadCount, [&](std::uint64_t begin, std::uint64_t end) {
+        for (auto i = begin; i < end; ++i)
+            dxfPolylines.coords[i] = toDxfCoord(jeoModel, jeoPolylines.pointIndexes[i]);
+    });
     return dxfModel;
 }
\ No newline at end of file
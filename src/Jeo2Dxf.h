@@ -1,6 +1,11 @@
 #pragma once
 
+#include <cstdint>
+
 class DxfModel;
 class JeoModel;
 
-DxfModel convertToDxf(const JeoModel& jeoModel);
\ No newline at end of file
+DxfModel convertToDxf(const JeoModel& jeoModel);
+
+// Same result as convertToDxf(jeoModel), entities being converted on threadCount threads
+DxfModel convertToDxf(const JeoModel& jeoModel, std::uint64_t threadCount);
\ No newline at end of file
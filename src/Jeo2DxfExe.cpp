@@ -1,4 +1,9 @@
+#include "Batch.h"
+#include "ConversionCache.h"
+#include "ConversionServer.h"
+#include "ConversionStats.h"
 #include "Dxf2JeoVersion.h"
+#include "DxfColors.h"
 #include "DxfModel.h"
 #include "DxfWriter.h"
 #include "Jeo2Dxf.h"
@@ -8,15 +13,30 @@
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <thread>
 
 namespace {
     auto getCLOptions()
     {
         auto options = cxxopts::Options{"jeo2dxf", "Converts a 2D .dxf file into Geometric Json .jeo file"};
-        options.add_options()                                                   //
-            ("i,input", "Input JEO file path", cxxopts::value<std::string>())   //
-            ("o,output", "Output DXF file path", cxxopts::value<std::string>()) //
-            ("v,version", "Display jeo2dxf version")                            //
+        options.add_options()                                                                                                                           //
+            ("i,input", "Input JEO file path (.jeo or .jeob), or JEO directory in batch mode", cxxopts::value<std::vector<std::string>>())              //
+            ("o,output", "Output DXF file path", cxxopts::value<std::string>())                                                                         //
+            ("t,threads", "Number of conversion threads", cxxopts::value<std::uint64_t>()->default_value("1"))                                          //
+            ("native-writer", "Write DXF files with the built-in ASCII writer instead of libdxfrw")                                                     //
+            ("m,manifest", "File listing input paths, one per line (batch mode)", cxxopts::value<std::string>())                                        //
+            ("d,output-dir", "Output directory, converting every input in batch mode", cxxopts::value<std::string>())                                   //
+            ("j,jobs", "Files converted concurrently in batch or server mode, 0 for one per core", cxxopts::value<std::uint64_t>()->default_value("0")) //
+            ("serve", "Serve conversion requests on this Unix socket until stopped", cxxopts::value<std::string>())                                     //
+            ("connect", "Convert through the server listening on this Unix socket", cxxopts::value<std::string>())                                      //
+            ("inline", "Send the input contents to the server instead of its path")                                                                     //
+            ("stop", "Stop the server given by --connect")                                                                                              //
+            ("cache-dir", "Directory caching converted files by input contents", cxxopts::value<std::string>())                                         //
+            ("cache-size", "Maximum size of the cache directory in MB", cxxopts::value<std::uint64_t>()->default_value("1024"))                         //
+            ("stats", "Print stage timings, counts and peak memory, as text or json", cxxopts::value<std::string>()->implicit_value("text"))            //
+            ("v,version", "Display jeo2dxf version")                                                                                                    //
             ("h,help", "Display this help");
         return options;
     }
@@ -41,6 +61,108 @@ namespace {
         return -1;
     }
 
+    void setJeoCounts(ConversionStats* stats, const JeoModel& jeoModel)
+    {
+        if (stats == nullptr)
+            return;
+
+        setCount(*stats, "lines", jeoModel.lines.size());
+        setCount(*stats, "arcs", jeoModel.arcs.size());
+        setCount(*stats, "polylines", jeoModel.polylines.size());
+        setCount(*stats, "points", jeoModel.points.size());
+        setCount(*stats, "colors", jeoModel.colors.size());
+        setCount(*stats, "tags", jeoModel.tags.size());
+    }
+
+    void convert(const std::filesystem::path& inputPath,
+                 const std::filesystem::path& outputPath,
+                 std::uint64_t                threadCount,
+                 DxfWriterKind                writerKind,
+                 ConversionStats*             stats)
+    {
+        const auto jeoModel = measureStage(stats, "read", [&]() { return readJeo(inputPath); });
+        setJeoCounts(stats, jeoModel);
+        const auto dxfModel = measureStage(stats, "convert", [&]() { return convertToDxf(jeoModel, threadCount); });
+        measureStage(stats, "write", [&]() { writeDxf(dxfModel, outputPath, writerKind); });
+    }
+
+    std::uint64_t getJobCount(const cxxopts::ParseResult& result)
+    {
+        const auto jobCount = result["jobs"].as<std::uint64_t>();
+        return jobCount != 0 ? jobCount : std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    std::unique_ptr<ConversionCache> makeCache(const cxxopts::ParseResult& result, std::string_view options)
+    {
+        if (result.count("cache-dir") == 0)
+            return nullptr;
+
+        const auto directory = std::filesystem::path{result["cache-dir"].as<std::string>()};
+        const auto maxSize   = result["cache-size"].as<std::uint64_t>() << 20;
+        const auto context   = fmt::format("jeo2dxf {}.{}.{}{}", DXF2JEO_VERSION_MAJOR, DXF2JEO_VERSION_MINOR, DXF2JEO_VERSION_PATCH, options);
+        return std::make_unique<ConversionCache>(directory, maxSize, context);
+    }
+
+    ConversionFunction withCache(ConversionCache* cache, ConversionFunction convert)
+    {
+        if (cache == nullptr)
+            return convert;
+
+        return [cache, convert = std::move(convert)](const std::filesystem::path& inputPath, const std::filesystem::path& outputPath) {
+            cache->convert(inputPath, outputPath, convert);
+        };
+    }
+
+    void printCacheStats(const ConversionCache* cache)
+    {
+        if (cache == nullptr)
+            return;
+
+        const auto stats = cache->stats();
+        fmt::print(std::cout, "Cache: {} hit(s), {} miss(es), {} eviction(s)\n", stats.hits, stats.misses, stats.evictions);
+    }
+
+    void printStats(ConversionStats&             stats,
+                    std::string_view             format,
+                    const std::filesystem::path& inputPath,
+                    const std::filesystem::path& outputPath,
+                    const ConversionCache*       cache)
+    {
+        stats.bytesIn  = std::filesystem::file_size(inputPath);
+        stats.bytesOut = std::filesystem::file_size(outputPath);
+        stats.peakRss  = getPeakRss();
+        if (cache != nullptr) {
+            const auto cacheStats = cache->stats();
+            setCount(stats, "cacheHits", cacheStats.hits);
+            setCount(stats, "cacheMisses", cacheStats.misses);
+        }
+        fmt::print(std::cout, "{}", format == "json" ? formatStatsJson(stats) : formatStatsText(stats));
+    }
+
+    int batch(const cxxopts::ParseResult& result, const ConversionFunction& convert)
+    {
+        auto inputPaths = std::vector<std::filesystem::path>{};
+        if (result.count("input"))
+            for (const auto& input : result["input"].as<std::vector<std::string>>())
+                inputPaths.emplace_back(input);
+        if (result.count("manifest"))
+            for (auto& input : readBatchManifest(result["manifest"].as<std::string>()))
+                inputPaths.push_back(std::move(input));
+
+        if (inputPaths.empty())
+            return error("input file paths must be provided");
+
+        const auto outputDir = std::filesystem::path{result["output-dir"].as<std::string>()};
+        create_directories(outputDir);
+
+        const auto items    = makeBatchItems(collectBatchInputs(inputPaths, {".jeo", ".jeob"}), outputDir, ".dxf");
+        const auto failures = runBatch(items, getJobCount(result), [&](const BatchItem& item) { convert(item.inputPath, item.outputPath); });
+        for (const auto& failure : failures)
+            fmt::print(std::cerr, "Error: {}: {}\n", failure.inputPath.string(), failure.message);
+        fmt::print(std::cout, "{} file(s) converted, {} failed\n", items.size() - failures.size(), failures.size());
+        return failures.empty() ? 0 : -1;
+    }
+
     int run(int argc, char** argv)
     {
         try {
@@ -52,22 +174,74 @@ namespace {
             if (result.count("version"))
                 return version();
 
+            const auto statsFormat = result.count("stats") ? result["stats"].as<std::string>() : std::string{};
+            if (result.count("stats")) {
+                if (statsFormat != "text" && statsFormat != "json")
+                    return error("unknown statistics format: {}", statsFormat);
+                if (result.count("serve") || result.count("connect") || result.count("output-dir"))
+                    return error("statistics are only available for a single local conversion");
+            }
+            auto stats = result.count("stats") ? std::optional<ConversionStats>{std::in_place} : std::nullopt;
+
+            // The thread count does not change the output, unlike the writer whose files differ in their formatting
+            const auto threadCount = result["threads"].as<std::uint64_t>();
+            const auto writerKind  = result.count("native-writer") != 0 ? DxfWriterKind::Native : DxfWriterKind::Libdxfrw;
+            const auto cache       = makeCache(result, writerKind == DxfWriterKind::Native ? " native-writer" : "");
+            const auto conversion  = withCache(cache.get(), [&](const std::filesystem::path& inputPath, const std::filesystem::path& outputPath) {
+                convert(inputPath, outputPath, threadCount, writerKind, stats ? &*stats : nullptr);
+            });
+
+            if (result.count("serve")) {
+                // Built on first use otherwise, by the first request needing it
+                dxfColorFromRGB({0, 0, 0});
+
+                runConversionServer(result["serve"].as<std::string>(), getJobCount(result), conversion);
+                printCacheStats(cache.get());
+                return 0;
+            }
+
+            if (result.count("connect") && result.count("stop")) {
+                requestServerStop(result["connect"].as<std::string>());
+                return 0;
+            }
+
+            if (result.count("output-dir")) {
+                const auto status = batch(result, conversion);
+                printCacheStats(cache.get());
+                return status;
+            }
+
             if (result.count("input") == 0)
                 return error("input file path must be provided");
 
             if (result.count("output") == 0)
                 return error("output file path must be provided");
 
-            const auto inputPath = std::filesystem::path{result["input"].as<std::string>()};
+            const auto inputs = result["input"].as<std::vector<std::string>>();
+            if (inputs.size() != 1)
+                return error("a single input file path must be provided, several ones need an output directory");
+
+            const auto inputPath = std::filesystem::path{inputs.front()};
             if (!std::filesystem::is_regular_file(inputPath))
                 return error("output file is not a regular file: {}", inputPath.string());
 
             const auto outputPath = std::filesystem::path{result["output"].as<std::string>()};
             create_directories(outputPath.parent_path());
 
-            const auto jeoModel = readJeo(inputPath);
-            const auto dxfModel = convertToDxf(jeoModel);
-            writeDxf(dxfModel, outputPath);
+            if (result.count("connect")) {
+                const auto socketPath = std::filesystem::path{result["connect"].as<std::string>()};
+                if (result.count("inline"))
+                    requestInlineConversion(socketPath, inputPath, outputPath);
+                else
+                    requestConversion(socketPath, inputPath, outputPath);
+                return 0;
+            }
+
+            measureStage(stats ? &*stats : nullptr, "total", [&]() { conversion(inputPath, outputPath); });
+            if (stats)
+                printStats(*stats, statsFormat, inputPath, outputPath, cache.get());
+            else
+                printCacheStats(cache.get());
 
             return 0;
         }
@@ -83,8 +257,7 @@ namespace {
 int main(int argc, char** argv)
 {
     try {
-        run(argc, argv);
-        return 0;
+        return run(argc, argv);
     }
     catch (...) {
         return -1;
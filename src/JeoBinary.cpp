@@ -0,0 +1,371 @@
+#include "JeoBinary.h"
+
+#include "JeoModel.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <fmt/format.h>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    constexpr auto MAGIC             = std::string_view{"JEOB"};
+    constexpr auto SECTION_COUNT     = static_cast<std::uint64_t>(JeoBinarySection::Count);
+    constexpr auto SECTION_ALIGNMENT = std::uint64_t{8};
+    constexpr auto HEADER_SIZE       = MAGIC.size() + 2 * sizeof(std::uint16_t) + sizeof(std::uint64_t) + SECTION_COUNT * 2 * sizeof(std::uint64_t);
+
+    static_assert(sizeof(JeoBinaryLine) == 4 * sizeof(std::uint64_t));
+    static_assert(sizeof(JeoBinaryArc) == 6 * sizeof(std::uint64_t));
+    static_assert(sizeof(JeoBinaryPolyline) == 3 * sizeof(std::uint64_t));
+    static_assert(HEADER_SIZE % SECTION_ALIGNMENT == 0);
+
+    void checkLittleEndian()
+    {
+        const auto value = std::uint16_t{1};
+        auto       bytes = std::array<std::uint8_t, 2>{};
+        std::memcpy(bytes.data(), &value, sizeof(value));
+        if (bytes[0] != 1)
+            throw std::runtime_error{"binary jeo files are only supported on little-endian hosts"};
+    }
+
+    std::uint64_t alignSection(std::uint64_t offset) { return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT; }
+
+    std::uint64_t toBinaryIndex(const std::optional<std::uint64_t>& index) { return index.value_or(JEO_BINARY_NO_INDEX); }
+
+    std::optional<std::uint64_t> fromBinaryIndex(std::uint64_t index)
+    {
+        if (index == JEO_BINARY_NO_INDEX)
+            return std::nullopt;
+        return index;
+    }
+
+    template<typename T> void writeValue(std::ofstream& out, const T& value) { out.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+    template<typename T> void writeValues(std::ofstream& out, const T* values, std::uint64_t count)
+    { //
+        out.write(reinterpret_cast<const char*>(values), static_cast<std::streamsize>(count * sizeof(T)));
+    }
+
+    // Writes count values produced by makeValue(i), going through a small buffer
+    template<typename T, typename Function> void writeValues(std::ofstream& out, std::uint64_t count, Function&& makeValue)
+    {
+        constexpr auto BUFFER_SIZE = std::uint64_t{4096};
+
+        auto buffer = std::vector<T>(std::min(count, BUFFER_SIZE));
+        for (std::uint64_t begin = 0; begin < count; begin += BUFFER_SIZE) {
+            const auto end = std::min(count, begin + BUFFER_SIZE);
+            for (auto i = begin; i < end; ++i)
+                buffer[i - begin] = makeValue(i);
+            writeValues(out, buffer.data(), end - begin);
+        }
+    }
+
+    template<typename T> T readValue(std::string_view bytes, std::uint64_t offset)
+    {
+        auto value = T{};
+        std::memcpy(&value, bytes.data() + offset, sizeof(T));
+        return value;
+    }
+
+    void checkOffsets(ArrayView<std::uint64_t> offsets, std::uint64_t count, std::uint64_t size, const char* name)
+    {
+        if (offsets.size() != count + 1 || offsets[0] != 0 || offsets[count] != size)
+            throw std::runtime_error{fmt::format("invalid binary jeo {} offsets", name)};
+        for (std::uint64_t i = 0; i < count; ++i)
+            if (offsets[i + 1] < offsets[i])
+                throw std::runtime_error{fmt::format("invalid binary jeo {} offsets", name)};
+    }
+}
+
+JeoBinaryView::JeoBinaryView(const std::filesystem::path& filePath) : inputFile_{filePath, InputFileAccess::Random}
+{
+    checkLittleEndian();
+    validate();
+}
+
+ArrayView<std::uint8_t> JeoBinaryView::colors() const { return section<std::uint8_t>(JeoBinarySection::Colors); }
+std::uint64_t           JeoBinaryView::tagCount() const { return section<std::uint64_t>(JeoBinarySection::TagOffsets).size() - 1; }
+
+std::string_view JeoBinaryView::tag(std::uint64_t tagIndex) const
+{
+    const auto tagOffsets = section<std::uint64_t>(JeoBinarySection::TagOffsets);
+    const auto tagChars   = sectionBytes(JeoBinarySection::TagChars);
+    return tagChars.substr(tagOffsets.at(tagIndex), tagOffsets.at(tagIndex + 1) - tagOffsets[tagIndex]);
+}
+
+ArrayView<double>            JeoBinaryView::pointsX() const { return section<double>(JeoBinarySection::PointsX); }
+ArrayView<double>            JeoBinaryView::pointsY() const { return section<double>(JeoBinarySection::PointsY); }
+ArrayView<double>            JeoBinaryView::pointsZ() const { return section<double>(JeoBinarySection::PointsZ); }
+ArrayView<JeoBinaryLine>     JeoBinaryView::lines() const { return section<JeoBinaryLine>(JeoBinarySection::Lines); }
+ArrayView<JeoBinaryArc>      JeoBinaryView::arcs() const { return section<JeoBinaryArc>(JeoBinarySection::Arcs); }
+ArrayView<JeoBinaryPolyline> JeoBinaryView::polylines() const { return section<JeoBinaryPolyline>(JeoBinarySection::Polylines); }
+ArrayView<std::uint64_t>     JeoBinaryView::polylinePointOffsets() const { return section<std::uint64_t>(JeoBinarySection::PolylinePointOffsets); }
+ArrayView<std::uint64_t>     JeoBinaryView::polylinePoints() const { return section<std::uint64_t>(JeoBinarySection::PolylinePoints); }
+ArrayView<std::uint64_t>     JeoBinaryView::polylineBulgeOffsets() const { return section<std::uint64_t>(JeoBinarySection::PolylineBulgeOffsets); }
+ArrayView<double>            JeoBinaryView::polylineBulges() const { return section<double>(JeoBinarySection::PolylineBulges); }
+
+ArrayView<std::uint64_t> JeoBinaryView::polylinePoints(std::uint64_t polylineIndex) const
+{
+    const auto offsets = section<std::uint64_t>(JeoBinarySection::PolylinePointOffsets);
+    const auto points  = section<std::uint64_t>(JeoBinarySection::PolylinePoints);
+    return {points.data() + offsets.at(polylineIndex), offsets.at(polylineIndex + 1) - offsets[polylineIndex]};
+}
+
+ArrayView<double> JeoBinaryView::polylineBulges(std::uint64_t polylineIndex) const
+{
+    const auto offsets = section<std::uint64_t>(JeoBinarySection::PolylineBulgeOffsets);
+    const auto bulges  = section<double>(JeoBinarySection::PolylineBulges);
+    return {bulges.data() + offsets.at(polylineIndex), offsets.at(polylineIndex + 1) - offsets[polylineIndex]};
+}
+
+template<typename T> ArrayView<T> JeoBinaryView::section(JeoBinarySection section) const
+{
+    const auto bytes = sectionBytes(section);
+    return {reinterpret_cast<const T*>(bytes.data()), bytes.size() / sizeof(T)};
+}
+
+std::string_view JeoBinaryView::sectionBytes(JeoBinarySection section) const
+{
+    const auto contents    = inputFile_.contents();
+    const auto entryOffset = MAGIC.size() + 2 * sizeof(std::uint16_t) + sizeof(std::uint64_t) + static_cast<std::uint64_t>(section) * 2 * sizeof(std::uint64_t);
+    const auto offset      = readValue<std::uint64_t>(contents, entryOffset);
+    const auto size        = readValue<std::uint64_t>(contents, entryOffset + sizeof(std::uint64_t));
+    return contents.substr(offset, size);
+}
+
+void JeoBinaryView::validate() const
+{
+    const auto contents = inputFile_.contents();
+    if (contents.size() < MAGIC.size() + 2 * sizeof(std::uint16_t) + sizeof(std::uint64_t) || contents.substr(0, MAGIC.size()) != MAGIC)
+        throw std::runtime_error{"not a binary jeo file"};
+
+    const auto versionMajor = readValue<std::uint16_t>(contents, MAGIC.size());
+    const auto versionMinor = readValue<std::uint16_t>(contents, MAGIC.size() + sizeof(std::uint16_t));
+    if (versionMajor != JEO_BINARY_VERSION_MAJOR)
+        throw std::runtime_error{fmt::format("unsupported binary jeo version number: {}.{}", versionMajor, versionMinor)};
+
+    // Later minor versions may only append sections
+    const auto sectionCount = readValue<std::uint64_t>(contents, MAGIC.size() + 2 * sizeof(std::uint16_t));
+    if (sectionCount < SECTION_COUNT || contents.size() < HEADER_SIZE)
+        throw std::runtime_error{"truncated binary jeo header"};
+
+    constexpr auto ELEMENT_SIZES =
+        std::array<std::uint64_t, SECTION_COUNT>{3, 8, 1, 8, 8, 8, sizeof(JeoBinaryLine), sizeof(JeoBinaryArc), sizeof(JeoBinaryPolyline), 8, 8, 8, 8};
+    for (std::uint64_t i = 0; i < SECTION_COUNT; ++i) {
+        const auto entryOffset = MAGIC.size() + 2 * sizeof(std::uint16_t) + sizeof(std::uint64_t) + i * 2 * sizeof(std::uint64_t);
+        const auto offset      = readValue<std::uint64_t>(contents, entryOffset);
+        const auto size        = readValue<std::uint64_t>(contents, entryOffset + sizeof(std::uint64_t));
+        if (offset % SECTION_ALIGNMENT != 0 || offset > contents.size() || size > contents.size() - offset || size % ELEMENT_SIZES[i] != 0)
+            throw std::runtime_error{fmt::format("invalid binary jeo section {}", i)};
+    }
+
+    const auto tagOffsets = section<std::uint64_t>(JeoBinarySection::TagOffsets);
+    if (tagOffsets.empty())
+        throw std::runtime_error{"invalid binary jeo tag offsets"};
+    checkOffsets(tagOffsets, tagOffsets.size() - 1, sectionBytes(JeoBinarySection::TagChars).size(), "tag");
+
+    const auto pointCount = pointsX().size();
+    if (pointsY().size() != pointCount || pointsZ().size() != pointCount)
+        throw std::runtime_error{"invalid binary jeo points"};
+
+    const auto polylines          = this->polylines();
+    const auto polylineCount      = polylines.size();
+    const auto polylinePointCount = section<std::uint64_t>(JeoBinarySection::PolylinePoints).size();
+    const auto polylineBulgeCount = section<double>(JeoBinarySection::PolylineBulges).size();
+    checkOffsets(section<std::uint64_t>(JeoBinarySection::PolylinePointOffsets), polylineCount, polylinePointCount, "polyline point");
+    checkOffsets(section<std::uint64_t>(JeoBinarySection::PolylineBulgeOffsets), polylineCount, polylineBulgeCount, "polyline bulge");
+    for (std::uint64_t i = 0; i < polylineCount; ++i) {
+        const auto hasBulges   = (polylines[i].flags & JEO_BINARY_POLYLINE_BULGES) != 0;
+        const auto bulgeCount  = polylineBulges(i).size();
+        const auto pointsCount = polylinePoints(i).size();
+        if (hasBulges ? bulgeCount != pointsCount : bulgeCount != 0)
+            throw std::runtime_error{"size of points and bulges must be equal"};
+    }
+}
+
+bool isJeoBinaryPath(const std::filesystem::path& filePath)
+{
+    auto extension = filePath.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    });
+    return extension == ".jeob";
+}
+
+void writeJeoBinary(const JeoModel& model, const std::filesystem::path& filePath)
+{
+    checkLittleEndian();
+
+    auto out = std::ofstream{filePath, std::ios::binary};
+    if (!out.is_open())
+        throw std::runtime_error{fmt::format("unable to write file {}", filePath.string())};
+
+    auto tagCharCount = std::uint64_t{0};
+    for (const auto& tag : model.tags)
+        tagCharCount += tag.size();
+
+    auto sectionSizes                                                                = std::array<std::uint64_t, SECTION_COUNT>{};
+    sectionSizes[static_cast<std::uint64_t>(JeoBinarySection::Colors)]               = 3 * model.colors.size();
+    sectionSizes[static_cast<std::uint64_t>(JeoBinarySection::TagOffsets)]           = sizeof(std::uint64_t) * (model.tags.size() + 1);
+    sectionSizes[static_cast<std::uint64_t>(JeoBinarySection::TagChars)]             = tagCharCount;
+    sectionSizes[static_cast<std::uint64_t>(JeoBinarySection::PointsX)]              = sizeof(double) * model.points.size();
+    sectionSizes[static_cast<std::uint64_t>(JeoBinarySection::PointsY)]              = sizeof(double) * model.points.size();
+    sectionSizes[static_cast<std::uint64_t>(JeoBinarySection::PointsZ)]              = sizeof(double) * model.points.size();
+    sectionSizes[static_cast<std::uint64_t>(JeoBinarySection::Lines)]                = sizeof(JeoBinaryLine) * model.lines.size();
+    sectionSizes[static_cast<std::uint64_t>(JeoBinarySection::Arcs)]                 = sizeof(JeoBinaryArc) * model.arcs.size();
+    sectionSizes[static_cast<std::uint64_t>(JeoBinarySection::Polylines)]            = sizeof(JeoBinaryPolyline) * model.polylines.size();
+    sectionSizes[static_cast<std::uint64_t>(JeoBinarySection::PolylinePointOffsets)] = sizeof(std::uint64_t) * model.polylines.pointOffsets.size();
+    sectionSizes[static_cast<std::uint64_t>(JeoBinarySection::PolylinePoints)]       = sizeof(std::uint64_t) * model.polylines.pointIndexes.size();
+    sectionSizes[static_cast<std::uint64_t>(JeoBinarySection::PolylineBulgeOffsets)] = sizeof(std::uint64_t) * model.polylines.bulgeOffsets.size();
+    sectionSizes[static_cast<std::uint64_t>(JeoBinarySection::PolylineBulges)]       = sizeof(double) * model.polylines.bulges.size();
+
+    auto sectionOffsets = std::array<std::uint64_t, SECTION_COUNT>{};
+    auto offset         = HEADER_SIZE;
+    for (std::uint64_t i = 0; i < SECTION_COUNT; ++i) {
+        sectionOffsets[i] = alignSection(offset);
+        offset            = sectionOffsets[i] + sectionSizes[i];
+    }
+
+    out.write(MAGIC.data(), static_cast<std::streamsize>(MAGIC.size()));
+    writeValue(out, JEO_BINARY_VERSION_MAJOR);
+    writeValue(out, JEO_BINARY_VERSION_MINOR);
+    writeValue(out, SECTION_COUNT);
+    for (std::uint64_t i = 0; i < SECTION_COUNT; ++i) {
+        writeValue(out, sectionOffsets[i]);
+        writeValue(out, sectionSizes[i]);
+    }
+
+    auto position     = HEADER_SIZE;
+    auto beginSection = [&](JeoBinarySection section) {
+        const auto sectionIndex = static_cast<std::uint64_t>(section);
+        const auto padding      = std::array<char, SECTION_ALIGNMENT>{};
+        out.write(padding.data(), static_cast<std::streamsize>(sectionOffsets[sectionIndex] - position));
+        position = sectionOffsets[sectionIndex] + sectionSizes[sectionIndex];
+    };
+
+    beginSection(JeoBinarySection::Colors);
+    for (const auto& color : model.colors)
+        writeValue(out, std::array{color.r, color.g, color.b});
+
+    beginSection(JeoBinarySection::TagOffsets);
+    auto tagOffset = std::uint64_t{0};
+    writeValue(out, tagOffset);
+    for (const auto& tag : model.tags)
+        writeValue(out, tagOffset += tag.size());
+
+    beginSection(JeoBinarySection::TagChars);
+    for (const auto& tag : model.tags)
+        out.write(tag.data(), static_cast<std::streamsize>(tag.size()));
+
+    beginSection(JeoBinarySection::PointsX);
+    writeValues(out, model.points.x.data(), model.points.size());
+    beginSection(JeoBinarySection::PointsY);
+    writeValues(out, model.points.y.data(), model.points.size());
+    beginSection(JeoBinarySection::PointsZ);
+    writeValues(out, model.points.z.data(), model.points.size());
+
+    beginSection(JeoBinarySection::Lines);
+    writeValues<JeoBinaryLine>(out, model.lines.size(), [&](std::uint64_t i) {
+        const auto& line = model.lines[i];
+        return JeoBinaryLine{toBinaryIndex(line.colorIndex), toBinaryIndex(line.tagIndex), line.firstPointIndex, line.lastPointIndex};
+    });
+
+    beginSection(JeoBinarySection::Arcs);
+    writeValues<JeoBinaryArc>(out, model.arcs.size(), [&](std::uint64_t i) {
+        const auto& arc = model.arcs[i];
+        return JeoBinaryArc{toBinaryIndex(arc.colorIndex), toBinaryIndex(arc.tagIndex), arc.centerIndex, arc.firstPointIndex, arc.lastPointIndex, arc.direct};
+    });
+
+    // Polyline vertices and bulges are stored the same way in the model, their arrays are written as they are
+    const auto& polylines = model.polylines;
+    beginSection(JeoBinarySection::Polylines);
+    writeValues<JeoBinaryPolyline>(out, polylines.size(), [&](std::uint64_t i) {
+        const auto& entity = polylines.entities[i];
+        const auto  flags  = (entity.closed ? JEO_BINARY_POLYLINE_CLOSED : 0) | (entity.hasBulges ? JEO_BINARY_POLYLINE_BULGES : 0);
+        return JeoBinaryPolyline{toBinaryIndex(entity.colorIndex), toBinaryIndex(entity.tagIndex), flags};
+    });
+
+    beginSection(JeoBinarySection::PolylinePointOffsets);
+    writeValues(out, polylines.pointOffsets.data(), polylines.pointOffsets.size());
+
+    beginSection(JeoBinarySection::PolylinePoints);
+    writeValues(out, polylines.pointIndexes.data(), polylines.pointIndexes.size());
+
+    beginSection(JeoBinarySection::PolylineBulgeOffsets);
+    writeValues(out, polylines.bulgeOffsets.data(), polylines.bulgeOffsets.size());
+
+    beginSection(JeoBinarySection::PolylineBulges);
+    writeValues(out, polylines.bulges.data(), polylines.bulges.size());
+
+    out.flush();
+    if (!out)
+        throw std::runtime_error{fmt::format("unable to write file {}", filePath.string())};
+}
+
+JeoModel readJeoBinary(const std::filesystem::path& filePath)
+{
+    const auto view = JeoBinaryView{filePath};
+
+    auto jeoModel = JeoModel{};
+
+    const auto colors = view.colors();
+    jeoModel.colors.resize(colors.size() / 3);
+    for (std::uint64_t i = 0, n = jeoModel.colors.size(); i < n; ++i)
+        jeoModel.colors[i] = JeoColor{colors[3 * i], colors[3 * i + 1], colors[3 * i + 2]};
+
+    jeoModel.tags.resize(view.tagCount());
+    for (std::uint64_t i = 0, n = jeoModel.tags.size(); i < n; ++i)
+        jeoModel.tags[i] = std::string{view.tag(i)};
+
+    const auto pointsX = view.pointsX();
+    const auto pointsY = view.pointsY();
+    const auto pointsZ = view.pointsZ();
+    jeoModel.points.x.assign(pointsX.begin(), pointsX.end());
+    jeoModel.points.y.assign(pointsY.begin(), pointsY.end());
+    jeoModel.points.z.assign(pointsZ.begin(), pointsZ.end());
+
+    const auto lines = view.lines();
+    jeoModel.lines.resize(lines.size());
+    for (std::uint64_t i = 0, n = jeoModel.lines.size(); i < n; ++i) {
+        auto& line           = jeoModel.lines[i];
+        line.colorIndex      = fromBinaryIndex(lines[i].colorIndex);
+        line.tagIndex        = fromBinaryIndex(lines[i].tagIndex);
+        line.firstPointIndex = lines[i].firstPointIndex;
+        line.lastPointIndex  = lines[i].lastPointIndex;
+    }
+
+    const auto arcs = view.arcs();
+    jeoModel.arcs.resize(arcs.size());
+    for (std::uint64_t i = 0, n = jeoModel.arcs.size(); i < n; ++i) {
+        auto& arc           = jeoModel.arcs[i];
+        arc.colorIndex      = fromBinaryIndex(arcs[i].colorIndex);
+        arc.tagIndex        = fromBinaryIndex(arcs[i].tagIndex);
+        arc.centerIndex     = arcs[i].centerIndex;
+        arc.firstPointIndex = arcs[i].firstPointIndex;
+        arc.lastPointIndex  = arcs[i].lastPointIndex;
+        arc.direct          = arcs[i].direct != 0;
+    }
+
+    const auto polylines = view.polylines();
+    jeoModel.polylines.entities.resize(polylines.size());
+    for (std::uint64_t i = 0, n = polylines.size(); i < n; ++i) {
+        auto& entity      = jeoModel.polylines.entities[i];
+        entity.colorIndex = fromBinaryIndex(polylines[i].colorIndex);
+        entity.tagIndex   = fromBinaryIndex(polylines[i].tagIndex);
+        entity.closed     = (polylines[i].flags & JEO_BINARY_POLYLINE_CLOSED) != 0;
+        entity.hasBulges  = (polylines[i].flags & JEO_BINARY_POLYLINE_BULGES) != 0;
+    }
+
+    const auto pointOffsets = view.polylinePointOffsets();
+    const auto pointIndexes = view.polylinePoints();
+    const auto bulgeOffsets = view.polylineBulgeOffsets();
+    const auto bulges       = view.polylineBulges();
+    jeoModel.polylines.pointOffsets.assign(pointOffsets.begin(), pointOffsets.end());
+    jeoModel.polylines.pointIndexes.assign(pointIndexes.begin(), pointIndexes.end());
+    jeoModel.polylines.bulgeOffsets.assign(bulgeOffsets.begin(), bulgeOffsets.end());
+    jeoModel.polylines.bulges.assign(bulges.begin(), bulges.end());
+
+    return jeoModel;
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "ArrayView.h"
+#include "InputFile.h"
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+struct JeoModel;
+
+// Binary sibling of the JEO format, written to and read from files with the .jeob extension.
+//
+// The file starts with a header made of the magic "JEOB", the format version as two little-endian
+// uint16 and the number of sections as a uint64, followed by one {offset, size} pair of uint64 per
+// section. Sections are stored in the order of JeoBinarySection, each one starting on an 8 bytes
+// boundary and holding little-endian fixed-width values, so that they can be used in place.
+// Optional indexes are stored as JEO_BINARY_NO_INDEX.
+
+constexpr std::uint16_t JEO_BINARY_VERSION_MAJOR = 1;
+constexpr std::uint16_t JEO_BINARY_VERSION_MINOR = 0;
+constexpr std::uint64_t JEO_BINARY_NO_INDEX      = ~std::uint64_t{0};
+
+constexpr std::uint64_t JEO_BINARY_POLYLINE_CLOSED = 1;
+constexpr std::uint64_t JEO_BINARY_POLYLINE_BULGES = 2;
+
+enum class JeoBinarySection : std::uint64_t
+{
+    Colors,               // uint8 r, g, b per color
+    TagOffsets,           // uint64 per tag + 1, offsets in TagChars
+    TagChars,             // tags concatenated
+    PointsX,              // double per point
+    PointsY,              // double per point
+    PointsZ,              // double per point
+    Lines,                // JeoBinaryLine per line
+    Arcs,                 // JeoBinaryArc per arc
+    Polylines,            // JeoBinaryPolyline per polyline
+    PolylinePointOffsets, // uint64 per polyline + 1, offsets in PolylinePoints
+    PolylinePoints,       // uint64 point index per polyline vertex
+    PolylineBulgeOffsets, // uint64 per polyline + 1, offsets in PolylineBulges
+    PolylineBulges,       // double per polyline vertex, only for polylines flagged with JEO_BINARY_POLYLINE_BULGES
+    Count
+};
+
+struct JeoBinaryLine
+{
+    std::uint64_t colorIndex;
+    std::uint64_t tagIndex;
+    std::uint64_t firstPointIndex;
+    std::uint64_t lastPointIndex;
+};
+
+struct JeoBinaryArc
+{
+    std::uint64_t colorIndex;
+    std::uint64_t tagIndex;
+    std::uint64_t centerIndex;
+    std::uint64_t firstPointIndex;
+    std::uint64_t lastPointIndex;
+    std::uint64_t direct;
+};
+
+struct JeoBinaryPolyline
+{
+    std::uint64_t colorIndex;
+    std::uint64_t tagIndex;
+    std::uint64_t flags;
+};
+
+// Validated view of a mapped .jeob file, exposing its sections without parsing them
+class JeoBinaryView
+{
+  public:
+    explicit JeoBinaryView(const std::filesystem::path& filePath);
+
+    ArrayView<std::uint8_t>      colors() const;
+    std::uint64_t                tagCount() const;
+    std::string_view             tag(std::uint64_t tagIndex) const;
+    ArrayView<double>            pointsX() const;
+    ArrayView<double>            pointsY() const;
+    ArrayView<double>            pointsZ() const;
+    ArrayView<JeoBinaryLine>     lines() const;
+    ArrayView<JeoBinaryArc>      arcs() const;
+    ArrayView<JeoBinaryPolyline> polylines() const;
+    ArrayView<std::uint64_t>     polylinePointOffsets() const;
+    ArrayView<std::uint64_t>     polylinePoints() const;
+    ArrayView<std::uint64_t>     polylinePoints(std::uint64_t polylineIndex) const;
+    ArrayView<std::uint64_t>     polylineBulgeOffsets() const;
+    ArrayView<double>            polylineBulges() const;
+    ArrayView<double>            polylineBulges(std::uint64_t polylineIndex) const;
+
+  private:
+    template<typename T> ArrayView<T> section(JeoBinarySection section) const;
+
+    std::string_view sectionBytes(JeoBinarySection section) const;
+    void             validate() const;
+
+    InputFile inputFile_;
+};
+
+bool     isJeoBinaryPath(const std::filesystem::path& filePath);
+void     writeJeoBinary(const JeoModel& model, const std::filesystem::path& filePath);
+JeoModel readJeoBinary(const std::filesystem::path& filePath);
\ No newline at end of file
@@ -1,7 +1,9 @@
 #pragma once
 
+#include "ArrayView.h"
 #include <cstdint>
 #include <optional>
+#include <stdexcept>
 #include <string>
 #include <variant>
 #include <vector>
@@ -20,6 +22,49 @@ struct JeoPoint
     double z = 0.;
 };
 
+// Points stored as separate x, y and z arrays, all of the same size, so that loops reading some coordinates
+// only touch those. Points are read as JeoPoint values, the arrays being used directly by hot loops.
+struct JeoPoints
+{
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+
+    std::uint64_t size() const { return x.size(); }
+    bool          empty() const { return x.empty(); }
+
+    JeoPoint operator[](std::uint64_t i) const { return {x[i], y[i], z[i]}; }
+    JeoPoint at(std::uint64_t i) const { return {x.at(i), y.at(i), z.at(i)}; }
+
+    void set(std::uint64_t i, const JeoPoint& point)
+    {
+        x[i] = point.x;
+        y[i] = point.y;
+        z[i] = point.z;
+    }
+
+    void push_back(const JeoPoint& point)
+    {
+        x.push_back(point.x);
+        y.push_back(point.y);
+        z.push_back(point.z);
+    }
+
+    void reserve(std::uint64_t size)
+    {
+        x.reserve(size);
+        y.reserve(size);
+        z.reserve(size);
+    }
+
+    void resize(std::uint64_t size)
+    {
+        x.resize(size);
+        y.resize(size);
+        z.resize(size);
+    }
+};
+
 struct JeoEntity
 {
     std::optional<uint64_t> colorIndex;
@@ -40,19 +85,80 @@ struct JeoArc : JeoEntity
     bool          direct          = true;
 };
 
+// Polyline as read from JeoPolylines, its vertices and bulges viewing the shared arrays
 struct JeoPolyline : JeoEntity
 {
-    std::vector<std::uint64_t>         pointIndexes;
-    std::optional<std::vector<double>> bulges;
-    bool                               closed = false;
+    ArrayView<std::uint64_t>         pointIndexes;
+    std::optional<ArrayView<double>> bulges;
+    bool                             closed = false;
+};
+
+// Per polyline part of JeoPolylines
+struct JeoPolylineEntity : JeoEntity
+{
+    bool closed    = false;
+    bool hasBulges = false;
+};
+
+// Vertices and bulges of all polylines stored back to back, sparing two allocations per polyline: polyline i owns
+// pointIndexes[pointOffsets[i], pointOffsets[i + 1]) and bulges[bulgeOffsets[i], bulgeOffsets[i + 1]), the latter
+// range being empty unless the polyline has bulges. The offsets hold one more value than there are polylines.
+struct JeoPolylines
+{
+    std::vector<JeoPolylineEntity> entities;
+    std::vector<std::uint64_t>     pointOffsets = {0};
+    std::vector<std::uint64_t>     pointIndexes;
+    std::vector<std::uint64_t>     bulgeOffsets = {0};
+    std::vector<double>            bulges;
+
+    std::uint64_t size() const { return entities.size(); }
+    bool          empty() const { return entities.empty(); }
+
+    JeoPolyline operator[](std::uint64_t i) const
+    {
+        const auto& entity           = entities[i];
+        const auto  polylineVertices = ArrayView<std::uint64_t>{pointIndexes.data() + pointOffsets[i], pointOffsets[i + 1] - pointOffsets[i]};
+        auto        polylineBulges   = std::optional<ArrayView<double>>{};
+        if (entity.hasBulges)
+            polylineBulges = ArrayView<double>{bulges.data() + bulgeOffsets[i], bulgeOffsets[i + 1] - bulgeOffsets[i]};
+        return {entity, polylineVertices, polylineBulges, entity.closed};
+    }
+
+    JeoPolyline at(std::uint64_t i) const
+    {
+        if (i >= size())
+            throw std::out_of_range{"polyline index out of range"};
+        return (*this)[i];
+    }
+
+    void push_back(const JeoPolyline& polyline)
+    {
+        auto entity      = JeoPolylineEntity{polyline};
+        entity.closed    = polyline.closed;
+        entity.hasBulges = polyline.bulges.has_value();
+        entities.push_back(entity);
+        pointIndexes.insert(pointIndexes.end(), polyline.pointIndexes.begin(), polyline.pointIndexes.end());
+        pointOffsets.push_back(pointIndexes.size());
+        if (polyline.bulges)
+            bulges.insert(bulges.end(), polyline.bulges->begin(), polyline.bulges->end());
+        bulgeOffsets.push_back(bulges.size());
+    }
+
+    void reserve(std::uint64_t polylineCount, std::uint64_t vertexCount)
+    {
+        entities.reserve(polylineCount);
+        pointOffsets.reserve(polylineCount + 1);
+        bulgeOffsets.reserve(polylineCount + 1);
+        pointIndexes.reserve(vertexCount);
+    }
 };
 
 struct JeoModel
 {
     std::vector<JeoColor>    colors;
     std::vector<std::string> tags;
-    std::vector<JeoPoint>    points;
+    JeoPoints                points;
     std::vector<JeoLine>     lines;
     std::vector<JeoArc>      arcs;
-    std::vector<JeoPolyline> polylines;
+    JeoPolylines             polylines;
 };
\ No newline at end of file
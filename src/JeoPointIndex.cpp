@@ -0,0 +1,355 @@
+#include "JeoPointIndex.h"
+
+#include "DistanceKernel.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace {
+    constexpr auto NO_POINT = std::numeric_limits<std::uint64_t>::max();
+
+    // Slightly larger than the tolerance so that rounding in the distance computation can never
+    // accept a point lying outside of the visited cells.
+    constexpr auto SEARCH_RADIUS_FACTOR = 1. + 1e-9;
+
+    std::int64_t toCell(double value, double cellSize)
+    {
+        constexpr auto CELL_LIMIT = static_cast<double>(std::numeric_limits<std::int64_t>::max() / 2);
+
+        const auto cell = std::floor(value / cellSize);
+        if (!(cell > -CELL_LIMIT))
+            return -static_cast<std::int64_t>(CELL_LIMIT);
+        if (!(cell < CELL_LIMIT))
+            return static_cast<std::int64_t>(CELL_LIMIT);
+        return static_cast<std::int64_t>(cell);
+    }
+
+    std::pair<std::int64_t, std::int64_t> toCellRange(double value, double cellSize)
+    {
+        const auto searchRadius = cellSize * SEARCH_RADIUS_FACTOR;
+        return {toCell(value - searchRadius, cellSize), toCell(value + searchRadius, cellSize)};
+    }
+
+    std::uint64_t cellKey(std::int64_t cellX, std::int64_t cellY)
+    {
+        // Distinct cells may share a key, this only adds candidates that are rejected by the distance test
+        return static_cast<std::uint64_t>(cellX) * 0x9E3779B97F4A7C15ull ^ static_cast<std::uint64_t>(cellY) * 0xC2B2AE3D27D4EB4Full;
+    }
+
+    std::uint64_t cellKey(const JeoPoint& point, double cellSize) { return cellKey(toCell(point.x, cellSize), toCell(point.y, cellSize)); }
+
+    // Gathers candidates scattered over the grid cells, so that they are tested against the query point a block at a time
+    class CandidateMatcher
+    {
+      public:
+        CandidateMatcher(const JeoPoints& points, const JeoPoint& point, double squaredTolerance)
+            : points_{&points}, point_{point}, squaredTolerance_{squaredTolerance}, kernel_{getBestDistanceKernel()}
+        {
+        }
+
+        template<typename Function> void add(std::uint64_t pointIndex, Function&& onMatch)
+        {
+            x_[size_]            = points_->x[pointIndex];
+            y_[size_]            = points_->y[pointIndex];
+            z_[size_]            = points_->z[pointIndex];
+            pointIndexes_[size_] = pointIndex;
+            if (++size_ == DISTANCE_BLOCK_SIZE)
+                flush(onMatch);
+        }
+
+        // Calls onMatch with the index of each added point lying within tolerance
+        template<typename Function> void flush(Function&& onMatch)
+        {
+            if (size_ == 0)
+                return;
+
+            const auto matches = matchWithinTolerance(kernel_, x_.data(), y_.data(), z_.data(), size_, point_, squaredTolerance_);
+            for (std::uint64_t i = 0; i < size_; ++i)
+                if ((matches >> i) & 1)
+                    onMatch(pointIndexes_[i]);
+            size_ = 0;
+        }
+
+      private:
+        const JeoPoints* points_;
+        JeoPoint         point_;
+        double           squaredTolerance_;
+        DistanceKernel   kernel_;
+
+        std::array<double, DISTANCE_BLOCK_SIZE>        x_;
+        std::array<double, DISTANCE_BLOCK_SIZE>        y_;
+        std::array<double, DISTANCE_BLOCK_SIZE>        z_;
+        std::array<std::uint64_t, DISTANCE_BLOCK_SIZE> pointIndexes_;
+        std::uint64_t                                  size_ = 0;
+    };
+
+    template<typename Function> void forEachNeighbourCell(const JeoPoint& point, double cellSize, Function&& function)
+    {
+        const auto [cellX1, cellX2] = toCellRange(point.x, cellSize);
+        const auto [cellY1, cellY2] = toCellRange(point.y, cellSize);
+        for (auto cellX = cellX1; cellX <= cellX2; ++cellX)
+            for (auto cellY = cellY1; cellY <= cellY2; ++cellY)
+                function(cellKey(cellX, cellY));
+    }
+
+    using ExactKey = std::array<std::uint64_t, 3>;
+
+    struct ExactKeyHash
+    {
+        std::size_t operator()(const ExactKey& key) const
+        {
+            return static_cast<std::size_t>((key[0] * 0x9E3779B97F4A7C15ull ^ key[1]) * 0xC2B2AE3D27D4EB4Full ^ key[2]);
+        }
+    };
+
+    std::uint64_t toBits(double value)
+    {
+        auto bits = std::uint64_t{0};
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    std::optional<ExactKey> toExactKey(const JeoPoint& point)
+    {
+        // A NaN coordinate never matches, not even an identical one
+        if (std::isnan(point.x) || std::isnan(point.y) || std::isnan(point.z))
+            return std::nullopt;
+
+        // Adding 0. turns -0. into 0., both values behave the same in the distance test
+        return ExactKey{toBits(point.x + 0.), toBits(point.y + 0.), toBits(point.z + 0.)};
+    }
+
+    // Distinct coordinates of a cell in increasing order, linked through nextInCell
+    struct CellChain
+    {
+        std::uint64_t first = NO_POINT;
+        std::uint64_t last  = NO_POINT;
+    };
+
+    // Part of the grid owned by one thread while it is built, then shared read-only by every thread.
+    // Only the first copy of exactly equal coordinates is stored in the grid, later copies simply reuse its result.
+    struct PointShard
+    {
+        std::unordered_map<std::uint64_t, CellChain>               cells;
+        std::unordered_map<ExactKey, std::uint64_t, ExactKeyHash> firstCopies;
+    };
+
+    std::uint64_t toShard(std::uint64_t cellKey, std::uint64_t shardCount) { return (cellKey >> 32) % shardCount; }
+
+    // Lowest matches kept for each coordinate. Where k coordinates meet at a node, keeping every earlier match would take
+    // about k * k / 2 candidates, while the lowest ones nearly always include the point the coordinate is welded to.
+    constexpr auto MAX_CANDIDATES = std::uint64_t{16};
+
+    // Candidates of each coordinate of a contiguous range, stored as offsets into a single array
+    struct CandidateChunk
+    {
+        std::uint64_t              begin = 0;
+        std::uint64_t              end   = 0;
+        std::vector<std::uint64_t> offsets;
+        std::vector<std::uint64_t> candidates;
+        std::vector<std::uint64_t> completeBelow; // Every match below it is a candidate of the coordinate
+    };
+}
+
+JeoPointIndex::JeoPointIndex(double tolerance) : tolerance_{tolerance}, squaredTolerance_{toSquaredTolerance(tolerance)} {}
+
+std::optional<std::uint64_t> JeoPointIndex::find(const JeoPoints& points, const JeoPoint& point) const
+{
+    auto       found   = std::optional<std::uint64_t>{};
+    auto       matcher = CandidateMatcher{points, point, squaredTolerance_};
+    const auto onMatch = [&](std::uint64_t pointIndex) {
+        if (!found || pointIndex < *found)
+            found = pointIndex;
+    };
+    forEachNeighbourCell(point, tolerance_, [&](std::uint64_t key) {
+        const auto it = cellHeads_.find(key);
+        if (it == cellHeads_.end())
+            return;
+
+        for (auto pointIndex = it->second; pointIndex != NO_POINT; pointIndex = nextInCell_[pointIndex])
+            if (!found || pointIndex < *found)
+                matcher.add(pointIndex, onMatch);
+    });
+    matcher.flush(onMatch);
+    return found;
+}
+
+void JeoPointIndex::insert(const JeoPoint& point, std::uint64_t pointIndex)
+{
+    if (pointIndex >= nextInCell_.size())
+        nextInCell_.resize(pointIndex + 1, NO_POINT);
+
+    const auto [it, inserted] = cellHeads_.try_emplace(cellKey(point, tolerance_), pointIndex);
+    if (!inserted) {
+        nextInCell_[pointIndex] = it->second;
+        it->second              = pointIndex;
+    }
+}
+
+JeoWeldedPoints weldPoints(const JeoPoints& coords, double tolerance, std::uint64_t threadCount)
+{
+    const auto coordCount       = static_cast<std::uint64_t>(coords.size());
+    const auto shardCount       = std::max<std::uint64_t>(threadCount, 1);
+    const auto squaredTolerance = toSquaredTolerance(tolerance);
+
+    auto cellKeys = std::vector<std::uint64_t>(coordCount);
+    parallelFor(coordCount, threadCount, [&](std::uint64_t begin, std::uint64_t end) {
+        for (auto i = begin; i < end; ++i)
+            cellKeys[i] = cellKey(toCell(coords.x[i], tolerance), toCell(coords.y[i], tolerance));
+    });
+
+    // Coordinates bucketed by shard with a counting sort, which keeps them in coordinate order within each shard
+    auto shardOffsets = std::vector<std::uint64_t>(shardCount + 1, 0);
+    for (const auto key : cellKeys)
+        ++shardOffsets[toShard(key, shardCount) + 1];
+    std::partial_sum(shardOffsets.begin(), shardOffsets.end(), shardOffsets.begin());
+    auto shardCoords    = std::vector<std::uint64_t>(coordCount);
+    auto shardPositions = std::vector<std::uint64_t>(shardOffsets.begin(), shardOffsets.end() - 1);
+    for (std::uint64_t i = 0; i < coordCount; ++i)
+        shardCoords[shardPositions[toShard(cellKeys[i], shardCount)]++] = i;
+
+    // Each shard is filled by a single thread, in coordinate order, with the coordinates of the cells it owns
+    auto shards     = std::vector<PointShard>(shardCount);
+    auto firstCopy  = std::vector<std::uint64_t>(coordCount);
+    auto nextInCell = std::vector<std::uint64_t>(coordCount, NO_POINT);
+    parallelFor(shardCount, threadCount, [&](std::uint64_t shardBegin, std::uint64_t shardEnd) {
+        for (auto shardIndex = shardBegin; shardIndex < shardEnd; ++shardIndex) {
+            auto& shard = shards[shardIndex];
+            for (auto k = shardOffsets[shardIndex]; k < shardOffsets[shardIndex + 1]; ++k) {
+                const auto i = shardCoords[k];
+                firstCopy[i] = i;
+                if (const auto exactKey = toExactKey(coords[i])) {
+                    const auto [copyIt, isFirstCopy] = shard.firstCopies.try_emplace(*exactKey, i);
+                    if (!isFirstCopy) {
+                        firstCopy[i] = copyIt->second;
+                        continue;
+                    }
+                }
+
+                const auto [cellIt, inserted] = shard.cells.try_emplace(cellKeys[i], CellChain{i, i});
+                if (!inserted) {
+                    nextInCell[cellIt->second.last] = i;
+                    cellIt->second.last             = i;
+                }
+            }
+        }
+    });
+
+    // Calls function with the distinct coordinates of a cell preceding coordinate i, in increasing order, until it returns false
+    const auto forEachEarlierInCell = [&](std::uint64_t key, std::uint64_t i, auto&& function) {
+        const auto& cells = shards[toShard(key, shardCount)].cells;
+        const auto  it    = cells.find(key);
+        if (it == cells.end())
+            return;
+
+        for (auto j = it->second.first; j < i && function(j); j = nextInCell[j]) {}
+    };
+
+    // Candidates of a coordinate are its lowest earlier distinct coordinates within tolerance, in increasing order. The walk of a
+    // cell stops once it has found MAX_CANDIDATES of them, later ones being only needed when none of the candidates is a point.
+    const auto chunkCount = std::min<std::uint64_t>(coordCount, shardCount * 8);
+    auto       chunks     = std::vector<CandidateChunk>(chunkCount);
+    parallelFor(chunkCount, threadCount, [&](std::uint64_t chunkBegin, std::uint64_t chunkEnd) {
+        for (auto chunkIndex = chunkBegin; chunkIndex < chunkEnd; ++chunkIndex) {
+            auto& chunk = chunks[chunkIndex];
+            chunk.begin = coordCount * chunkIndex / chunkCount;
+            chunk.end   = coordCount * (chunkIndex + 1) / chunkCount;
+            chunk.offsets.reserve(chunk.end - chunk.begin + 1);
+            chunk.offsets.push_back(0);
+            chunk.completeBelow.reserve(chunk.end - chunk.begin);
+
+            for (auto i = chunk.begin; i < chunk.end; ++i) {
+                auto completeBelow = i;
+                if (firstCopy[i] == i) {
+                    const auto candidatesBegin = chunk.candidates.size();
+                    const auto point           = coords[i];
+                    auto       matcher         = CandidateMatcher{coords, point, squaredTolerance};
+                    auto       cellMatchCount  = std::uint64_t{0};
+                    const auto onMatch         = [&](std::uint64_t j) {
+                        chunk.candidates.push_back(j);
+                        ++cellMatchCount;
+                    };
+                    forEachNeighbourCell(point, tolerance, [&](std::uint64_t key) {
+                        cellMatchCount = 0;
+                        forEachEarlierInCell(key, i, [&](std::uint64_t j) {
+                            matcher.add(j, onMatch);
+                            if (cellMatchCount < MAX_CANDIDATES)
+                                return true;
+
+                            completeBelow = std::min(completeBelow, j + 1);
+                            return false;
+                        });
+                        matcher.flush(onMatch);
+                    });
+
+                    const auto candidates = chunk.candidates.begin() + candidatesBegin;
+                    std::sort(candidates, chunk.candidates.end());
+                    if (chunk.candidates.end() - candidates > static_cast<std::ptrdiff_t>(MAX_CANDIDATES))
+                        completeBelow = std::min(completeBelow, candidates[MAX_CANDIDATES - 1] + 1);
+                    chunk.candidates.erase(std::lower_bound(candidates, chunk.candidates.end(), completeBelow), chunk.candidates.end());
+                }
+                chunk.offsets.push_back(chunk.candidates.size());
+                chunk.completeBelow.push_back(completeBelow);
+            }
+        }
+    });
+
+    // A distinct coordinate becomes a new point unless one of its candidates is already a point, the first
+    // one being the lowest point index that the sequential lookup would have returned
+    auto weldedPoints = JeoWeldedPoints{};
+    weldedPoints.pointIndexes.resize(coordCount);
+    auto isPoint = std::vector<bool>(coordCount, false);
+
+    // Lowest point from coordinate from to coordinate i within tolerance of coordinate i, for coordinates whose candidates
+    // were cut short without any of them being a point
+    const auto findLowestPoint = [&](std::uint64_t i, std::uint64_t from) {
+        auto       found   = std::optional<std::uint64_t>{};
+        const auto point   = coords[i];
+        auto       matcher = CandidateMatcher{coords, point, squaredTolerance};
+        const auto onMatch = [&](std::uint64_t j) {
+            if (!found || j < *found)
+                found = j;
+        };
+        forEachNeighbourCell(point, tolerance, [&](std::uint64_t key) {
+            forEachEarlierInCell(key, i, [&](std::uint64_t j) {
+                if (j >= from && isPoint[j])
+                    matcher.add(j, onMatch);
+                return !found || j < *found;
+            });
+        });
+        matcher.flush(onMatch);
+        return found;
+    };
+
+    for (const auto& chunk : chunks) {
+        for (auto i = chunk.begin; i < chunk.end; ++i) {
+            if (firstCopy[i] != i) {
+                weldedPoints.pointIndexes[i] = weldedPoints.pointIndexes[firstCopy[i]];
+                continue;
+            }
+
+            const auto candidatesBegin = chunk.candidates.begin() + chunk.offsets[i - chunk.begin];
+            const auto candidatesEnd   = chunk.candidates.begin() + chunk.offsets[i - chunk.begin + 1];
+            const auto completeBelow   = chunk.completeBelow[i - chunk.begin];
+            auto       found           = std::optional<std::uint64_t>{};
+            if (const auto it = std::find_if(candidatesBegin, candidatesEnd, [&](std::uint64_t j) { return isPoint[j]; }); it != candidatesEnd)
+                found = *it;
+            else if (completeBelow < i)
+                found = findLowestPoint(i, completeBelow);
+
+            if (found) {
+                weldedPoints.pointIndexes[i] = weldedPoints.pointIndexes[*found];
+            }
+            else {
+                isPoint[i]                   = true;
+                weldedPoints.pointIndexes[i] = weldedPoints.points.size();
+                weldedPoints.points.push_back(coords[i]);
+            }
+        }
+    }
+    return weldedPoints;
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "JeoModel.h"
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Uniform grid over the x/y plane used to weld points within a distance tolerance.
+// Cells are tolerance-sized so a query only has to visit its neighbouring cells, and
+// find() returns the lowest matching point index, which is what a linear scan would return.
+class JeoPointIndex
+{
+  public:
+    explicit JeoPointIndex(double tolerance);
+
+    std::optional<std::uint64_t> find(const JeoPoints& points, const JeoPoint& point) const;
+    void                         insert(const JeoPoint& point, std::uint64_t pointIndex);
+
+  private:
+    double                                           tolerance_;
+    double                                           squaredTolerance_;
+    std::unordered_map<std::uint64_t, std::uint64_t> cellHeads_;
+    std::vector<std::uint64_t>                       nextInCell_;
+};
+
+struct JeoWeldedPoints
+{
+    JeoPoints                  points;
+    std::vector<std::uint64_t> pointIndexes;
+};
+
+// Welds coordinates on up to threadCount threads. The result is the same as looking up each coordinate in order
+// in a JeoPointIndex and appending it when no point matches: points are numbered in first-seen order.
+JeoWeldedPoints weldPoints(const JeoPoints& coords, double tolerance, std::uint64_t threadCount);
\ No newline at end of file
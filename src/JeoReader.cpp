@@ -1,9 +1,12 @@
 #include "JeoReader.h"
 
+#include "InputFile.h"
+#include "JeoBinary.h"
 #include "JeoModel.h"
+#include <charconv>
 #include <fmt/format.h>
-#include <fstream>
 #include <jsoncons/json.hpp>
+#include <jsoncons/json_cursor.hpp>
 
 namespace {
     // clang-format off
@@ -52,20 +55,6 @@ namespace {
         return arc;
     }
 
-    auto fromJson(Type<JeoPolyline>, const jsoncons::ojson& json)
-    {
-        auto polyline         = JeoPolyline{fromJson(Type<JeoEntity>{}, json)};
-        polyline.pointIndexes = json["points"].as<std::vector<std::uint64_t>>();
-        if (json.contains("bulges"))
-            polyline.bulges = json["bulges"].as<std::vector<double>>();
-        polyline.closed = json["closed"].as_bool();
-
-        if (polyline.bulges && polyline.bulges->size() != polyline.pointIndexes.size())
-            throw std::runtime_error{"size of points and bulges must be equal"};
-
-        return polyline;
-    }
-
     template<typename T> auto fromJson(Type<std::vector<T>>, const jsoncons::ojson& json)
     {
         if (!json.is_array())
@@ -77,30 +66,390 @@ namespace {
             elements.push_back(fromJson(Type<T>{}, json[i]));
         return elements;
     }
+
+    auto fromJson(Type<JeoPoints>, const jsoncons::ojson& json)
+    {
+        if (!json.is_array())
+            throw std::runtime_error{"json element must be an array"};
+
+        auto points = JeoPoints{};
+        points.reserve(json.size());
+        for (uint64_t i = 0, n = json.size(); i < n; ++i)
+            points.push_back(fromJson(Type<JeoPoint>{}, json[i]));
+        return points;
+    }
+
+    auto fromJson(Type<JeoPolylines>, const jsoncons::ojson& json)
+    {
+        if (!json.is_array())
+            throw std::runtime_error{"json element must be an array"};
+
+        auto polylines = JeoPolylines{};
+        for (uint64_t i = 0, n = json.size(); i < n; ++i) {
+            const auto& element      = json[i];
+            const auto  pointIndexes = element["points"].as<std::vector<std::uint64_t>>();
+            auto        bulges       = std::optional<std::vector<double>>{};
+            if (element.contains("bulges"))
+                bulges = element["bulges"].as<std::vector<double>>();
+
+            const auto closed = element["closed"].as_bool();
+
+            if (bulges && bulges->size() != pointIndexes.size())
+                throw std::runtime_error{"size of points and bulges must be equal"};
+
+            const auto bulgesView = bulges ? std::optional{ArrayView<double>{*bulges}} : std::nullopt;
+            polylines.push_back({fromJson(Type<JeoEntity>{}, element), pointIndexes, bulgesView, closed});
+        }
+        return polylines;
+    }
+
+    void checkVersion(std::uint64_t jeoVersionMajor, std::uint64_t jeoVersionMinor)
+    {
+        if (jeoVersionMajor < 2)
+            throw std::runtime_error{"jeo file with version < 2 are no longer supported"};
+        if (jeoVersionMajor != 2 || jeoVersionMinor != 0)
+            throw std::runtime_error{fmt::format("unsupported version number: {}.{}", jeoVersionMajor, jeoVersionMinor)};
+    }
+
+    // Pull parser filling the model while the document is read: every read function consumes
+    // one complete json value and leaves the cursor on the event that follows it.
+    using JsonCursor = jsoncons::json_string_cursor;
+    using JsonEvent  = jsoncons::staj_event_type;
+
+    void expectEvent(const JsonCursor& cursor, JsonEvent event, const char* message)
+    {
+        if (cursor.done() || cursor.current().event_type() != event)
+            throw std::runtime_error{message};
+    }
+
+    void skipValue(JsonCursor& cursor)
+    {
+        auto depth = 0;
+        do {
+            switch (cursor.current().event_type()) {
+            case JsonEvent::begin_array:
+            case JsonEvent::begin_object: ++depth; break;
+            case JsonEvent::end_array:
+            case JsonEvent::end_object: --depth; break;
+            default: break;
+            }
+            cursor.next();
+        } while (depth > 0 && !cursor.done());
+    }
+
+    template<typename Function> void readArray(JsonCursor& cursor, Function&& readElement)
+    {
+        expectEvent(cursor, JsonEvent::begin_array, "json element must be an array");
+        cursor.next();
+        while (!cursor.done() && cursor.current().event_type() != JsonEvent::end_array)
+            readElement();
+        expectEvent(cursor, JsonEvent::end_array, "json array is not terminated");
+        cursor.next();
+    }
+
+    template<typename Function> void readObject(JsonCursor& cursor, Function&& readMember)
+    {
+        expectEvent(cursor, JsonEvent::begin_object, "json element must be an object");
+        cursor.next();
+        while (!cursor.done() && cursor.current().event_type() != JsonEvent::end_object) {
+            expectEvent(cursor, JsonEvent::key, "json object key expected");
+            const auto key = cursor.current().get<std::string>();
+            cursor.next();
+            readMember(key);
+        }
+        expectEvent(cursor, JsonEvent::end_object, "json object is not terminated");
+        cursor.next();
+    }
+
+    template<typename T> T readValue(JsonCursor& cursor);
+
+    template<> std::uint64_t readValue(JsonCursor& cursor)
+    {
+        const auto& event = cursor.current();
+        if (event.event_type() != JsonEvent::uint64_value && event.event_type() != JsonEvent::int64_value)
+            throw std::runtime_error{"json element must be an unsigned integer"};
+        const auto value = event.get<std::uint64_t>();
+        cursor.next();
+        return value;
+    }
+
+    template<> std::uint8_t readValue(JsonCursor& cursor)
+    {
+        const auto value = readValue<std::uint64_t>(cursor);
+        if (value > 255)
+            throw std::runtime_error{"json element must be a color component"};
+        return static_cast<std::uint8_t>(value);
+    }
+
+    // Decimal numbers come as their source text (lossless_number), converted with from_chars
+    template<> double readValue(JsonCursor& cursor)
+    {
+        const auto& event = cursor.current();
+        if (event.event_type() == JsonEvent::string_value && event.tag() == jsoncons::semantic_tag::bigdec) {
+            const auto text   = event.get<jsoncons::string_view>();
+            auto       value  = 0.0;
+            const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+            if (result.ec != std::errc{} || result.ptr != text.data() + text.size())
+                throw std::runtime_error{fmt::format("json element must be a double: {}", std::string_view{text.data(), text.size()})};
+            cursor.next();
+            return value;
+        }
+        if (event.event_type() != JsonEvent::double_value && event.event_type() != JsonEvent::uint64_value && event.event_type() != JsonEvent::int64_value)
+            throw std::runtime_error{"json element must be a number"};
+        const auto value = event.get<double>();
+        cursor.next();
+        return value;
+    }
+
+    template<> bool readValue(JsonCursor& cursor)
+    {
+        expectEvent(cursor, JsonEvent::bool_value, "json element must be a boolean");
+        const auto value = cursor.current().get<bool>();
+        cursor.next();
+        return value;
+    }
+
+    template<> std::string readValue(JsonCursor& cursor)
+    {
+        expectEvent(cursor, JsonEvent::string_value, "json element must be a string");
+        if (cursor.current().tag() == jsoncons::semantic_tag::bigdec)
+            throw std::runtime_error{"json element must be a string"};
+        auto value = cursor.current().get<std::string>();
+        cursor.next();
+        return value;
+    }
+
+    template<typename T, std::size_t N> std::array<T, N> readFixedArray(JsonCursor& cursor)
+    {
+        auto        values = std::array<T, N>{};
+        std::size_t count  = 0;
+        readArray(cursor, [&]() {
+            if (count == N)
+                throw std::runtime_error{fmt::format("json array must have {} elements", N)};
+            values[count++] = readValue<T>(cursor);
+        });
+        if (count != N)
+            throw std::runtime_error{fmt::format("json array must have {} elements", N)};
+        return values;
+    }
+
+    template<typename T> std::vector<T> readVector(JsonCursor& cursor)
+    {
+        auto values = std::vector<T>{};
+        readArray(cursor, [&]() { values.push_back(readValue<T>(cursor)); });
+        return values;
+    }
+
+    void checkMember(bool found, const char* name)
+    {
+        if (!found)
+            throw std::runtime_error{fmt::format("missing json member: {}", name)};
+    }
+
+    bool readEntityMember(JsonCursor& cursor, const std::string& key, JeoEntity& entity)
+    {
+        if (key == "color")
+            entity.colorIndex = readValue<std::uint64_t>(cursor);
+        else if (key == "tag")
+            entity.tagIndex = readValue<std::uint64_t>(cursor);
+        else
+            return false;
+        return true;
+    }
+
+    template<> JeoColor readValue(JsonCursor& cursor)
+    {
+        const auto colorArray = readFixedArray<std::uint8_t, 3>(cursor);
+        return JeoColor{colorArray[0], colorArray[1], colorArray[2]};
+    }
+
+    template<> JeoPoint readValue(JsonCursor& cursor)
+    {
+        const auto pointArray = readFixedArray<double, 3>(cursor);
+        return JeoPoint{pointArray[0], pointArray[1], pointArray[2]};
+    }
+
+    JeoPoints readPoints(JsonCursor& cursor)
+    {
+        auto points = JeoPoints{};
+        readArray(cursor, [&]() { points.push_back(readValue<JeoPoint>(cursor)); });
+        return points;
+    }
+
+    template<> JeoLine readValue(JsonCursor& cursor)
+    {
+        auto line      = JeoLine{};
+        auto hasPoints = false;
+        readObject(cursor, [&](const std::string& key) {
+            if (key == "points") {
+                const auto pointIndexes = readFixedArray<std::uint64_t, 2>(cursor);
+                line.firstPointIndex    = pointIndexes[0];
+                line.lastPointIndex     = pointIndexes[1];
+                hasPoints               = true;
+            }
+            else if (!readEntityMember(cursor, key, line))
+                skipValue(cursor);
+        });
+        checkMember(hasPoints, "points");
+        return line;
+    }
+
+    template<> JeoArc readValue(JsonCursor& cursor)
+    {
+        auto arc       = JeoArc{};
+        auto hasPoints = false;
+        auto hasDirect = false;
+        readObject(cursor, [&](const std::string& key) {
+            if (key == "points") {
+                const auto pointIndexes = readFixedArray<std::uint64_t, 3>(cursor);
+                arc.centerIndex         = pointIndexes[0];
+                arc.firstPointIndex     = pointIndexes[1];
+                arc.lastPointIndex      = pointIndexes[2];
+                hasPoints               = true;
+            }
+            else if (key == "direct") {
+                arc.direct = readValue<bool>(cursor);
+                hasDirect  = true;
+            }
+            else if (!readEntityMember(cursor, key, arc))
+                skipValue(cursor);
+        });
+        checkMember(hasPoints, "points");
+        checkMember(hasDirect, "direct");
+        return arc;
+    }
+
+    // Vertices and bulges are read straight into the arrays shared by all polylines, a repeated member replacing the previous one
+    void readPolyline(JsonCursor& cursor, JeoPolylines& polylines)
+    {
+        auto& pointIndexes = polylines.pointIndexes;
+        auto& bulges       = polylines.bulges;
+        auto  entity       = JeoPolylineEntity{};
+        auto  hasPoints    = false;
+        auto  hasClosed    = false;
+        readObject(cursor, [&](const std::string& key) {
+            if (key == "points") {
+                pointIndexes.resize(polylines.pointOffsets.back());
+                readArray(cursor, [&]() { pointIndexes.push_back(readValue<std::uint64_t>(cursor)); });
+                hasPoints = true;
+            }
+            else if (key == "bulges") {
+                bulges.resize(polylines.bulgeOffsets.back());
+                readArray(cursor, [&]() { bulges.push_back(readValue<double>(cursor)); });
+                entity.hasBulges = true;
+            }
+            else if (key == "closed") {
+                entity.closed = readValue<bool>(cursor);
+                hasClosed     = true;
+            }
+            else if (!readEntityMember(cursor, key, entity))
+                skipValue(cursor);
+        });
+        checkMember(hasPoints, "points");
+        checkMember(hasClosed, "closed");
+
+        if (entity.hasBulges && bulges.size() - polylines.bulgeOffsets.back() != pointIndexes.size() - polylines.pointOffsets.back())
+            throw std::runtime_error{"size of points and bulges must be equal"};
+
+        polylines.entities.push_back(entity);
+        polylines.pointOffsets.push_back(pointIndexes.size());
+        polylines.bulgeOffsets.push_back(bulges.size());
+    }
+
+    JeoPolylines readPolylines(JsonCursor& cursor)
+    {
+        auto polylines = JeoPolylines{};
+        readArray(cursor, [&]() { readPolyline(cursor, polylines); });
+        return polylines;
+    }
+
+    JeoModel readJeoModel(JsonCursor& cursor)
+    {
+        auto jeoModel   = JeoModel{};
+        auto hasVersion = false;
+        auto hasMembers = std::array<bool, 6>{};
+
+        const auto readMember = [&](std::size_t memberIndex, auto& values) {
+            values                  = readVector<typename std::decay_t<decltype(values)>::value_type>(cursor);
+            hasMembers[memberIndex] = true;
+        };
+
+        readObject(cursor, [&](const std::string& key) {
+            if (key == "version") {
+                auto jeoVersionMajor = std::optional<std::uint64_t>{};
+                auto jeoVersionMinor = std::optional<std::uint64_t>{};
+                readObject(cursor, [&](const std::string& key) {
+                    if (key == "major")
+                        jeoVersionMajor = readValue<std::uint64_t>(cursor);
+                    else if (key == "minor")
+                        jeoVersionMinor = readValue<std::uint64_t>(cursor);
+                    else
+                        skipValue(cursor);
+                });
+                checkMember(jeoVersionMajor.has_value(), "major");
+                checkMember(jeoVersionMinor.has_value(), "minor");
+                checkVersion(*jeoVersionMajor, *jeoVersionMinor);
+                hasVersion = true;
+            }
+            else if (key == "colors")
+                readMember(0, jeoModel.colors);
+            else if (key == "tags")
+                readMember(1, jeoModel.tags);
+            else if (key == "points") {
+                jeoModel.points = readPoints(cursor);
+                hasMembers[2]   = true;
+            }
+            else if (key == "lines")
+                readMember(3, jeoModel.lines);
+            else if (key == "arcs")
+                readMember(4, jeoModel.arcs);
+            else if (key == "polylines") {
+                jeoModel.polylines = readPolylines(cursor);
+                hasMembers[5]      = true;
+            }
+            else
+                skipValue(cursor);
+        });
+
+        checkMember(hasVersion, "version");
+        const auto memberNames = std::array{"colors", "tags", "points", "lines", "arcs", "polylines"};
+        for (std::size_t i = 0; i < hasMembers.size(); ++i)
+            checkMember(hasMembers[i], memberNames[i]);
+
+        return jeoModel;
+    }
 }
 
 JeoModel readJeo(const std::filesystem::path& filePath)
 {
-    auto in = std::ifstream{filePath};
-    if (!in.is_open())
-        throw std::runtime_error{fmt::format("unable to read file {}", filePath.string())};
+    if (isJeoBinaryPath(filePath))
+        return readJeoBinary(filePath);
+
+    const auto inputFile = InputFile{filePath, InputFileAccess::Sequential};
+
+    auto jsonOptions = jsoncons::json_options{};
+    jsonOptions.lossless_number(true);
 
-    const auto json = jsoncons::ojson::parse(in);
+    auto cursor = JsonCursor{inputFile.contents(), jsonOptions};
+    return readJeoModel(cursor);
+}
+
+JeoModel readJeoDom(const std::filesystem::path& filePath)
+{
+    const auto inputFile = InputFile{filePath, InputFileAccess::Sequential};
+    const auto json      = jsoncons::ojson::parse(inputFile.contents());
 
     const auto jeoVersionMajor = json["version"]["major"].as<std::uint64_t>();
     const auto jeoVersionMinor = json["version"]["minor"].as<std::uint64_t>();
-    if (jeoVersionMajor < 2)
-        throw std::runtime_error{"jeo file with version < 2 are no longer supported"};
-    if (jeoVersionMajor != 2 || jeoVersionMinor != 0)
-        throw std::runtime_error{fmt::format("unsupported version number: {}.{}", jeoVersionMajor, jeoVersionMinor)};
+    checkVersion(jeoVersionMajor, jeoVersionMinor);
 
     auto jeoModel      = JeoModel{};
     jeoModel.colors    = fromJson(Type<std::vector<JeoColor>>{}, json["colors"]);
     jeoModel.tags      = json["tags"].as<std::vector<std::string>>();
-    jeoModel.points    = fromJson(Type<std::vector<JeoPoint>>{}, json["points"]);
+    jeoModel.points    = fromJson(Type<JeoPoints>{}, json["points"]);
     jeoModel.lines     = fromJson(Type<std::vector<JeoLine>>{}, json["lines"]);
     jeoModel.arcs      = fromJson(Type<std::vector<JeoArc>>{}, json["arcs"]);
-    jeoModel.polylines = fromJson(Type<std::vector<JeoPolyline>>{}, json["polylines"]);
+    jeoModel.polylines = fromJson(Type<JeoPolylines>{}, json["polylines"]);
 
     return jeoModel;
 }
\ No newline at end of file
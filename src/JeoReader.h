@@ -4,4 +4,8 @@
 
 struct JeoModel;
 
-JeoModel readJeo(const std::filesystem::path& filePath);
\ No newline at end of file
+// Reads a .jeo file, or a binary .jeob file
+JeoModel readJeo(const std::filesystem::path& filePath);
+
+// Same as readJeo, going through a complete jsoncons::ojson document first
+JeoModel readJeoDom(const std::filesystem::path& filePath);
\ No newline at end of file
@@ -1,81 +1,169 @@
 #include "JeoWriter.h"
 
+#include "JeoBinary.h"
 #include "JeoModel.h"
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include <fmt/format.h>
 #include <fstream>
 #include <jsoncons/json.hpp>
 
 namespace {
-    auto toJson(const JeoColor& color) { return std::array{color.r, color.g, color.b}; }
-    auto toJson(const JeoPoint& point) { return std::array{point.x, point.y, point.z}; }
+    // The document is streamed straight from the model, the events are the ones jsoncons::ojson::dump
+    // would emit for the equivalent tree so the layout of the file is unchanged, apart from doubles.
+    using JsonEncoder = jsoncons::json_stream_encoder;
 
-    auto toJson(const JeoEntity& entity)
+    void toJson(JsonEncoder& encoder, std::uint64_t value) { encoder.uint64_value(value); }
+
+    // Writes the shortest decimal reading back to the same double, passed through as a raw number by the bigdec tag
+    void toJson(JsonEncoder& encoder, double value)
+    {
+        if (!std::isfinite(value)) {
+            encoder.double_value(value);
+            return;
+        }
+
+        auto       buffer = std::array<char, 32>{};
+        const auto end    = fmt::format_to(buffer.data(), "{}", value);
+        auto       size   = static_cast<std::size_t>(end - buffer.data());
+        if (std::none_of(buffer.data(), end, [](char c) { return c == '.' || c == 'e'; })) {
+            buffer[size++] = '.';
+            buffer[size++] = '0';
+        }
+        encoder.string_value(jsoncons::string_view{buffer.data(), size}, jsoncons::semantic_tag::bigdec);
+    }
+
+    void toJson(JsonEncoder& encoder, const std::string& value) { encoder.string_value(value); }
+
+    template<typename T> void toJson(JsonEncoder& encoder, const std::vector<T>& elements);
+
+    template<typename T> void toJson(JsonEncoder& encoder, ArrayView<T> elements)
+    {
+        encoder.begin_array(elements.size());
+        for (const auto& element : elements)
+            toJson(encoder, element);
+        encoder.end_array();
+    }
+
+    template<typename T, std::size_t N> void toJson(JsonEncoder& encoder, const std::array<T, N>& elements)
+    {
+        encoder.begin_array(N);
+        for (const auto& element : elements)
+            toJson(encoder, element);
+        encoder.end_array();
+    }
+
+    void toJson(JsonEncoder& encoder, const JeoColor& color) { toJson(encoder, std::array<std::uint64_t, 3>{color.r, color.g, color.b}); }
+    void toJson(JsonEncoder& encoder, const JeoPoint& point) { toJson(encoder, std::array{point.x, point.y, point.z}); }
+
+    void toJson(JsonEncoder& encoder, const JeoPoints& points)
     {
-        auto json = jsoncons::ojson{};
-        if (entity.colorIndex)
-            json.insert_or_assign("color", entity.colorIndex.value());
-        if (entity.tagIndex)
-            json.insert_or_assign("tag", entity.tagIndex.value());
-        return json;
+        encoder.begin_array(points.size());
+        for (std::uint64_t i = 0, n = points.size(); i < n; ++i)
+            toJson(encoder, points[i]);
+        encoder.end_array();
     }
 
-    auto toJson(const JeoLine& line)
+    void toJsonEntity(JsonEncoder& encoder, const JeoEntity& entity)
     {
-        auto json = toJson(static_cast<const JeoEntity&>(line));
-        json.insert_or_assign("points", std::array{line.firstPointIndex, line.lastPointIndex});
-        return json;
+        if (entity.colorIndex) {
+            encoder.key("color");
+            toJson(encoder, entity.colorIndex.value());
+        }
+        if (entity.tagIndex) {
+            encoder.key("tag");
+            toJson(encoder, entity.tagIndex.value());
+        }
     }
 
-    auto toJson(const JeoArc& arc)
+    void toJson(JsonEncoder& encoder, const JeoLine& line)
     {
-        auto json = toJson(static_cast<const JeoEntity&>(arc));
-        json.insert_or_assign("points", std::array{arc.centerIndex, arc.firstPointIndex, arc.lastPointIndex});
-        json.insert_or_assign("direct", arc.direct);
-        return json;
+        encoder.begin_object();
+        toJsonEntity(encoder, line);
+        encoder.key("points");
+        toJson(encoder, std::array{line.firstPointIndex, line.lastPointIndex});
+        encoder.end_object();
     }
 
-    auto toJson(const JeoPolyline& polyline)
+    void toJson(JsonEncoder& encoder, const JeoArc& arc)
     {
-        auto json = toJson(static_cast<const JeoEntity&>(polyline));
-        json.insert_or_assign("points", polyline.pointIndexes);
-        if (polyline.bulges)
-            json.insert_or_assign("bulges", polyline.bulges.value());
-        json.insert_or_assign("closed", polyline.closed);
-        return json;
+        encoder.begin_object();
+        toJsonEntity(encoder, arc);
+        encoder.key("points");
+        toJson(encoder, std::array{arc.centerIndex, arc.firstPointIndex, arc.lastPointIndex});
+        encoder.key("direct");
+        encoder.bool_value(arc.direct);
+        encoder.end_object();
     }
 
-    template<typename T> auto toJson(const std::vector<T>& elements)
+    void toJson(JsonEncoder& encoder, const JeoPolyline& polyline)
     {
-        auto json = jsoncons::ojson::make_array();
-        json.reserve(elements.size());
+        encoder.begin_object();
+        toJsonEntity(encoder, polyline);
+        encoder.key("points");
+        toJson(encoder, polyline.pointIndexes);
+        if (polyline.bulges) {
+            encoder.key("bulges");
+            toJson(encoder, polyline.bulges.value());
+        }
+        encoder.key("closed");
+        encoder.bool_value(polyline.closed);
+        encoder.end_object();
+    }
+
+    void toJson(JsonEncoder& encoder, const JeoPolylines& polylines)
+    {
+        encoder.begin_array(polylines.size());
+        for (std::uint64_t i = 0, n = polylines.size(); i < n; ++i)
+            toJson(encoder, polylines[i]);
+        encoder.end_array();
+    }
+
+    template<typename T> void toJson(JsonEncoder& encoder, const std::vector<T>& elements)
+    {
+        encoder.begin_array(elements.size());
         for (const auto& element : elements)
-            json.push_back(toJson(element));
-        return json;
+            toJson(encoder, element);
+        encoder.end_array();
+    }
+
+    template<typename T> void toJsonMember(JsonEncoder& encoder, std::string_view name, const T& value)
+    {
+        encoder.key(name);
+        toJson(encoder, value);
     }
 }
 
 void writeJeo(const JeoModel& model, const std::filesystem::path& filePath)
 {
+    if (isJeoBinaryPath(filePath))
+        return writeJeoBinary(model, filePath);
+
     auto out = std::ofstream{filePath};
     if (!out.is_open())
         throw std::runtime_error{fmt::format("unable to write file {}", filePath.string())};
 
-    auto jsonVersion = jsoncons::ojson{};
-    jsonVersion.insert_or_assign("major", 2);
-    jsonVersion.insert_or_assign("minor", 0);
-
-    auto json = jsoncons::ojson{};
-    json.insert_or_assign("version", jsonVersion);
-    json.insert_or_assign("colors", toJson(model.colors));
-    json.insert_or_assign("tags", model.tags);
-    json.insert_or_assign("points", toJson(model.points));
-    json.insert_or_assign("lines", toJson(model.lines));
-    json.insert_or_assign("arcs", toJson(model.arcs));
-    json.insert_or_assign("polylines", toJson(model.polylines));
-
     auto jsonOptions = jsoncons::json_options{};
-    jsonOptions.precision(20);
+    jsonOptions.bignum_format(jsoncons::bignum_format_kind::raw);
     jsonOptions.array_array_line_splits(jsoncons::line_split_kind::same_line);
-    json.dump(out, jsonOptions, jsoncons::indenting::indent);
+
+    auto encoder = JsonEncoder{out, jsonOptions};
+    encoder.begin_object();
+    encoder.key("version");
+    encoder.begin_object();
+    toJsonMember(encoder, "major", std::uint64_t{2});
+    toJsonMember(encoder, "minor", std::uint64_t{0});
+    encoder.end_object();
+    toJsonMember(encoder, "colors", model.colors);
+    toJsonMember(encoder, "tags", model.tags);
+    toJsonMember(encoder, "points", model.points);
+    toJsonMember(encoder, "lines", model.lines);
+    toJsonMember(encoder, "arcs", model.arcs);
+    toJsonMember(encoder, "polylines", model.polylines);
+    encoder.end_object();
+    encoder.flush();
+
+    if (!out)
+        throw std::runtime_error{fmt::format("unable to write file {}", filePath.string())};
 }
\ No newline at end of file
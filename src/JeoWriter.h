@@ -4,4 +4,5 @@
 
 struct JeoModel;
 
+// Writes a .jeo file, or a binary .jeob file
 void writeJeo(const JeoModel& model, const std::filesystem::path& filePath);
\ No newline at end of file
@@ -0,0 +1,43 @@
+#include "Parallel.h"
+
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+void parallelFor(std::uint64_t count, std::uint64_t threadCount, const std::function<void(std::uint64_t, std::uint64_t)>& function)
+{
+    threadCount = std::clamp<std::uint64_t>(threadCount, 1, std::max<std::uint64_t>(count, 1));
+    if (threadCount == 1) {
+        function(0, count);
+        return;
+    }
+
+    auto exception      = std::exception_ptr{};
+    auto exceptionMutex = std::mutex{};
+
+    const auto runRange = [&](std::uint64_t rangeIndex) {
+        const auto begin = count * rangeIndex / threadCount;
+        const auto end   = count * (rangeIndex + 1) / threadCount;
+        try {
+            function(begin, end);
+        }
+        catch (...) {
+            const auto lock = std::lock_guard{exceptionMutex};
+            if (!exception)
+                exception = std::current_exception();
+        }
+    };
+
+    auto threads = std::vector<std::thread>{};
+    threads.reserve(threadCount - 1);
+    for (std::uint64_t rangeIndex = 1; rangeIndex < threadCount; ++rangeIndex)
+        threads.emplace_back(runRange, rangeIndex);
+    runRange(0);
+    for (auto& thread : threads)
+        thread.join();
+
+    if (exception)
+        std::rethrow_exception(exception);
+}
\ No newline at end of file
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+// Splits [0, count) into contiguous ranges and calls function(begin, end) for each of them on up to threadCount threads.
+// The first exception thrown by a range is rethrown once every thread has completed.
+void parallelFor(std::uint64_t count, std::uint64_t threadCount, const std::function<void(std::uint64_t, std::uint64_t)>& function);
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+    // Pool and worker index of the calling thread, when it is a worker
+    thread_local const ThreadPool* currentPool        = nullptr;
+    thread_local std::uint64_t     currentWorkerIndex = 0;
+}
+
+ThreadPool::ThreadPool(std::uint64_t threadCount)
+{
+    threadCount = std::max<std::uint64_t>(threadCount, 1);
+    for (std::uint64_t i = 0; i < threadCount; ++i)
+        workers_.push_back(std::make_unique<Worker>());
+    for (std::uint64_t i = 0; i < threadCount; ++i)
+        threads_.emplace_back([this, i]() { run(i); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        const auto lock = std::lock_guard{mutex_};
+        stopping_       = true;
+    }
+    taskAvailable_.notify_all();
+    for (auto& thread : threads_)
+        thread.join();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    const auto workerIndex = currentPool == this ? currentWorkerIndex : nextWorker_++ % workers_.size();
+    {
+        // Counted first and under the pool mutex, so that a worker going to sleep cannot miss the task
+        const auto lock = std::lock_guard{mutex_};
+        ++pendingCount_;
+        ++queuedCount_;
+    }
+    {
+        auto&      worker = *workers_[workerIndex];
+        const auto lock   = std::lock_guard{worker.mutex};
+        worker.tasks.push_back(std::move(task));
+    }
+    taskAvailable_.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    auto lock = std::unique_lock{mutex_};
+    tasksDone_.wait(lock, [this]() { return pendingCount_ == 0; });
+    if (exception_)
+        std::rethrow_exception(std::exchange(exception_, nullptr));
+}
+
+bool ThreadPool::popTask(std::uint64_t workerIndex, std::function<void()>& task)
+{
+    {
+        auto&      worker = *workers_[workerIndex];
+        const auto lock   = std::lock_guard{worker.mutex};
+        if (!worker.tasks.empty()) {
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+            --queuedCount_;
+            return true;
+        }
+    }
+    for (std::uint64_t i = 1, n = workers_.size(); i < n; ++i) {
+        auto&      victim = *workers_[(workerIndex + i) % n];
+        const auto lock   = std::lock_guard{victim.mutex};
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --queuedCount_;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(std::uint64_t workerIndex)
+{
+    currentPool        = this;
+    currentWorkerIndex = workerIndex;
+
+    auto task = std::function<void()>{};
+    while (true) {
+        if (!popTask(workerIndex, task)) {
+            auto lock = std::unique_lock{mutex_};
+            taskAvailable_.wait(lock, [this]() { return stopping_ || queuedCount_ > 0; });
+            if (stopping_ && queuedCount_ == 0)
+                return;
+            continue;
+        }
+
+        auto exception = std::exception_ptr{};
+        try {
+            task();
+        }
+        catch (...) {
+            exception = std::current_exception();
+        }
+        task = nullptr;
+
+        const auto lock = std::lock_guard{mutex_};
+        if (exception && !exception_)
+            exception_ = exception;
+        if (--pendingCount_ == 0)
+            tasksDone_.notify_all();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each one owning a deque of tasks. A worker takes its own tasks from the back
+// and steals from the front of the other deques once it runs out of work. Tasks submitted from a worker go
+// to its own deque, the other ones are spread round-robin.
+class ThreadPool
+{
+  public:
+    explicit ThreadPool(std::uint64_t threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::uint64_t threadCount() const { return workers_.size(); }
+
+    void submit(std::function<void()> task);
+
+    // Blocks until every submitted task has completed, then rethrows the first exception thrown by a task
+    void wait();
+
+  private:
+    struct Worker
+    {
+        std::mutex                        mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool popTask(std::uint64_t workerIndex, std::function<void()>& task);
+    void run(std::uint64_t workerIndex);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread>             threads_;
+    std::atomic<std::uint64_t>           queuedCount_{0};
+    std::atomic<std::uint64_t>           nextWorker_{0};
+
+    std::mutex              mutex_;
+    std::condition_variable taskAvailable_;
+    std::condition_variable tasksDone_;
+    std::uint64_t           pendingCount_ = 0;
+    bool                    stopping_     = false;
+    std::exception_ptr      exception_;
+};
\ No newline at end of file
@@ -0,0 +1,361 @@
+#include "ArcKernel.h"
+#include "DistanceKernel.h"
+#include "Dxf2Jeo.h"
+#include "DxfGenerator.h"
+#include "DxfModel.h"
+#include "DxfReader.h"
+#include "DxfWriter.h"
+#include "Jeo2Dxf.h"
+#include "JeoModel.h"
+#include "JeoReader.h"
+#include "JeoWriter.h"
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fmt/format.h>
+#include <map>
+#include <random>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    constexpr auto MIN_ENTITY_COUNT = std::int64_t{1'000};
+    constexpr auto MAX_ENTITY_COUNT = std::int64_t{1'000'000};
+
+    // Points heavy models draw as many lines, arcs and 16 vertex polylines on a few layers, sharing half of their points.
+    // Tags heavy models draw lines only, with explicit colors and about as many distinct PE_URL tags as lines.
+    enum class ModelKind
+    {
+        PointsHeavy,
+        TagsHeavy
+    };
+
+    // Input files are written by each run into a new directory, removed on exit, so that runs on different commits never
+    // measure files left by the writers of another one, nor files truncated by an interrupted run
+    class WorkDir
+    {
+      public:
+        WorkDir()
+        {
+            auto random = std::random_device{};
+            do
+                path_ = std::filesystem::temp_directory_path() / fmt::format("dxf2jeo_bench_{:08x}", random());
+            while (!std::filesystem::create_directory(path_));
+        }
+
+        ~WorkDir()
+        {
+            auto error = std::error_code{};
+            std::filesystem::remove_all(path_, error);
+        }
+
+        WorkDir(const WorkDir&)            = delete;
+        WorkDir& operator=(const WorkDir&) = delete;
+
+        const std::filesystem::path& path() const { return path_; }
+
+      private:
+        std::filesystem::path path_;
+    };
+
+    const std::filesystem::path& getWorkDir()
+    {
+        static const auto workDir = WorkDir{};
+        return workDir.path();
+    }
+
+    DxfModel makeDxfModel(std::uint64_t entityCount, ModelKind kind)
+    {
+        auto options = DxfGeneratorOptions{};
+        options.seed = entityCount;
+        if (kind == ModelKind::PointsHeavy) {
+            options.lineCount     = entityCount - 2 * (entityCount / 3);
+            options.arcCount      = entityCount / 3;
+            options.polylineCount = entityCount / 3;
+        }
+        else {
+            options.lineCount     = entityCount;
+            options.arcCount      = 0;
+            options.polylineCount = 0;
+            options.colorCount    = 255;
+            options.tagCount      = entityCount;
+        }
+        return generateDxfModel(options);
+    }
+
+    // Inputs are built once per entity count and kind, then shared by every benchmark
+    const DxfModel& getDxfModel(std::uint64_t entityCount, ModelKind kind)
+    {
+        static auto dxfModels = std::map<std::pair<std::uint64_t, ModelKind>, DxfModel>{};
+        auto        it        = dxfModels.find({entityCount, kind});
+        if (it == dxfModels.end())
+            it = dxfModels.emplace(std::pair{entityCount, kind}, makeDxfModel(entityCount, kind)).first;
+        return it->second;
+    }
+
+    const JeoModel& getJeoModel(std::uint64_t entityCount)
+    {
+        static auto jeoModels = std::map<std::uint64_t, JeoModel>{};
+        auto        it        = jeoModels.find(entityCount);
+        if (it == jeoModels.end())
+            it = jeoModels.emplace(entityCount, convertToJeo(getDxfModel(entityCount, ModelKind::PointsHeavy))).first;
+        return it->second;
+    }
+
+    std::filesystem::path getDxfFile(std::uint64_t entityCount)
+    {
+        const auto filePath = getWorkDir() / fmt::format("points_{}.dxf", entityCount);
+        if (!std::filesystem::exists(filePath))
+            writeDxf(getDxfModel(entityCount, ModelKind::PointsHeavy), filePath);
+        return filePath;
+    }
+
+    std::filesystem::path getJeoFile(std::uint64_t entityCount, std::string_view extension)
+    {
+        const auto filePath = getWorkDir() / fmt::format("points_{}{}", entityCount, extension);
+        if (!std::filesystem::exists(filePath))
+            writeJeo(getJeoModel(entityCount), filePath);
+        return filePath;
+    }
+
+    void setProcessed(benchmark::State& state, std::uint64_t entityCount, const std::filesystem::path& filePath = {})
+    {
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(entityCount));
+        if (!filePath.empty())
+            state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(std::filesystem::file_size(filePath)));
+    }
+
+    void readDxfBench(benchmark::State& state, DxfReaderKind kind)
+    {
+        const auto entityCount = static_cast<std::uint64_t>(state.range(0));
+        const auto filePath    = getDxfFile(entityCount);
+        for (auto _ : state)
+            benchmark::DoNotOptimize(readDxf(filePath, kind));
+        setProcessed(state, entityCount, filePath);
+    }
+
+    // Wall time of the native reading of the largest file on 1 thread, then twice as many up to the number of cores
+    void parallelReadDxfBench(benchmark::State& state)
+    {
+        const auto entityCount = static_cast<std::uint64_t>(state.range(0));
+        const auto threadCount = static_cast<std::uint64_t>(state.range(1));
+        const auto filePath    = getDxfFile(entityCount);
+        for (auto _ : state)
+            benchmark::DoNotOptimize(readDxf(filePath, DxfReaderKind::Native, threadCount));
+        setProcessed(state, entityCount, filePath);
+    }
+
+    void convertToJeoBench(benchmark::State& state, ModelKind kind)
+    {
+        const auto  entityCount = static_cast<std::uint64_t>(state.range(0));
+        const auto& dxfModel    = getDxfModel(entityCount, kind);
+        for (auto _ : state)
+            benchmark::DoNotOptimize(convertToJeo(dxfModel));
+        setProcessed(state, entityCount);
+    }
+
+    void writeJeoBench(benchmark::State& state, std::string_view extension)
+    {
+        const auto  entityCount = static_cast<std::uint64_t>(state.range(0));
+        const auto& jeoModel    = getJeoModel(entityCount);
+        const auto  filePath    = getWorkDir() / fmt::format("written_{}{}", entityCount, extension);
+        for (auto _ : state)
+            writeJeo(jeoModel, filePath);
+        setProcessed(state, entityCount, filePath);
+    }
+
+    void readJeoBench(benchmark::State& state, std::string_view extension)
+    {
+        const auto entityCount = static_cast<std::uint64_t>(state.range(0));
+        const auto filePath    = getJeoFile(entityCount, extension);
+        for (auto _ : state)
+            benchmark::DoNotOptimize(readJeo(filePath));
+        setProcessed(state, entityCount, filePath);
+    }
+
+    void convertToDxfBench(benchmark::State& state)
+    {
+        const auto  entityCount = static_cast<std::uint64_t>(state.range(0));
+        const auto& jeoModel    = getJeoModel(entityCount);
+        for (auto _ : state)
+            benchmark::DoNotOptimize(convertToDxf(jeoModel));
+        setProcessed(state, entityCount);
+    }
+
+    // Wall time of the conversion of the largest model on 1 thread, then twice as many up to the number of cores
+    void parallelConvertToDxfBench(benchmark::State& state)
+    {
+        const auto  entityCount = static_cast<std::uint64_t>(state.range(0));
+        const auto  threadCount = static_cast<std::uint64_t>(state.range(1));
+        const auto& jeoModel    = getJeoModel(entityCount);
+        for (auto _ : state)
+            benchmark::DoNotOptimize(convertToDxf(jeoModel, threadCount));
+        setProcessed(state, entityCount);
+    }
+
+    void writeDxfBench(benchmark::State& state, DxfWriterKind kind)
+    {
+        const auto  entityCount = static_cast<std::uint64_t>(state.range(0));
+        const auto& dxfModel    = getDxfModel(entityCount, ModelKind::PointsHeavy);
+        const auto  filePath    = getWorkDir() / fmt::format("written_{}.dxf", entityCount);
+        for (auto _ : state)
+            writeDxf(dxfModel, filePath, kind);
+        setProcessed(state, entityCount, filePath);
+    }
+
+    // Candidates scattered around the origin, half of them within the tolerance, as the point index gathers them from its cells
+    const JeoPoints& getCandidates()
+    {
+        static const auto candidates = [] {
+            auto random = std::mt19937_64{42};
+            auto jitter = std::uniform_real_distribution<double>{-1e-3, 1e-3};
+            auto points = JeoPoints{};
+            for (std::uint64_t i = 0; i < 1024 * DISTANCE_BLOCK_SIZE; ++i)
+                points.push_back({jitter(random), jitter(random), jitter(random)});
+            return points;
+        }();
+        return candidates;
+    }
+
+    void distanceKernelBench(benchmark::State& state, DistanceKernel kernel)
+    {
+        if (!isSupported(kernel)) {
+            state.SkipWithError("distance kernel not supported by this processor");
+            return;
+        }
+
+        const auto& candidates       = getCandidates();
+        const auto  origin           = JeoPoint{};
+        const auto  squaredTolerance = toSquaredTolerance(1e-3);
+        for (auto _ : state) {
+            for (std::uint64_t i = 0, n = candidates.size(); i < n; i += DISTANCE_BLOCK_SIZE) {
+                const auto* x       = candidates.x.data() + i;
+                const auto* y       = candidates.y.data() + i;
+                const auto* z       = candidates.z.data() + i;
+                const auto  matches = matchWithinTolerance(kernel, x, y, z, DISTANCE_BLOCK_SIZE, origin, squaredTolerance);
+                benchmark::DoNotOptimize(matches);
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(candidates.size()));
+    }
+
+    // Reference for the kernels, testing each candidate in turn as the point index used to
+    void distanceSqrtBench(benchmark::State& state)
+    {
+        const auto& candidates = getCandidates();
+        for (auto _ : state) {
+            for (std::uint64_t i = 0, n = candidates.size(); i < n; i += DISTANCE_BLOCK_SIZE) {
+                auto matches = std::uint64_t{0};
+                for (std::uint64_t j = 0; j < DISTANCE_BLOCK_SIZE; ++j) {
+                    const auto point = candidates[i + j];
+                    if (std::sqrt(point.x * point.x + point.y * point.y + point.z * point.z) <= 1e-3)
+                        matches |= std::uint64_t{1} << j;
+                }
+                benchmark::DoNotOptimize(matches);
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(candidates.size()));
+    }
+
+    // Arcs of random radiuses and end angles, centered on the origin
+    const std::vector<ArcBlock>& getArcBlocks()
+    {
+        static const auto blocks = [] {
+            auto random = std::mt19937_64{42};
+            auto angle  = std::uniform_real_distribution<double>{-3.14, 3.14};
+            auto radius = std::uniform_real_distribution<double>{1e-3, 1e3};
+            auto blocks = std::vector<ArcBlock>(64);
+            for (auto& block : blocks) {
+                block.size = ARC_BLOCK_SIZE;
+                for (std::uint64_t i = 0; i < ARC_BLOCK_SIZE; ++i) {
+                    const auto r      = radius(random);
+                    const auto theta1 = angle(random);
+                    const auto theta2 = angle(random);
+                    block.firstDx[i]  = r * std::cos(theta1);
+                    block.firstDy[i]  = r * std::sin(theta1);
+                    block.lastDx[i]   = r * std::cos(theta2);
+                    block.lastDy[i]   = r * std::sin(theta2);
+                }
+            }
+            return blocks;
+        }();
+        return blocks;
+    }
+
+    void arcKernelBench(benchmark::State& state, ArcKernel kernel)
+    {
+        if (!isSupported(kernel)) {
+            state.SkipWithError("arc kernel not supported by this processor");
+            return;
+        }
+
+        auto blocks = getArcBlocks();
+        for (auto _ : state) {
+            for (auto& block : blocks) {
+                evaluateArcs(kernel, block);
+                benchmark::DoNotOptimize(block.theta2.data());
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(blocks.size() * ARC_BLOCK_SIZE));
+    }
+
+    void entityCounts(benchmark::internal::Benchmark* bench)
+    {
+        bench->RangeMultiplier(10)->Range(MIN_ENTITY_COUNT, MAX_ENTITY_COUNT)->Unit(benchmark::kMillisecond);
+    }
+
+    void threadCounts(benchmark::internal::Benchmark* bench)
+    {
+        bench->ArgNames({"entities", "threads"})->UseRealTime()->Unit(benchmark::kMillisecond);
+        const auto coreCount = std::max<std::int64_t>(std::thread::hardware_concurrency(), 1);
+        for (std::int64_t threadCount = 1; threadCount < coreCount; threadCount *= 2)
+            bench->Args({MAX_ENTITY_COUNT, threadCount});
+        bench->Args({MAX_ENTITY_COUNT, coreCount});
+    }
+}
+
+BENCHMARK_CAPTURE(readDxfBench, libdxfrw, DxfReaderKind::Libdxfrw)->Apply(entityCounts);
+BENCHMARK_CAPTURE(readDxfBench, native, DxfReaderKind::Native)->Apply(entityCounts);
+BENCHMARK(parallelReadDxfBench)->Apply(threadCounts);
+BENCHMARK_CAPTURE(convertToJeoBench, pointsHeavy, ModelKind::PointsHeavy)->Apply(entityCounts);
+BENCHMARK_CAPTURE(convertToJeoBench, tagsHeavy, ModelKind::TagsHeavy)->Apply(entityCounts);
+BENCHMARK_CAPTURE(writeJeoBench, json, ".jeo")->Apply(entityCounts);
+BENCHMARK_CAPTURE(writeJeoBench, binary, ".jeob")->Apply(entityCounts);
+BENCHMARK_CAPTURE(readJeoBench, json, ".jeo")->Apply(entityCounts);
+BENCHMARK_CAPTURE(readJeoBench, binary, ".jeob")->Apply(entityCounts);
+BENCHMARK(convertToDxfBench)->Apply(entityCounts);
+BENCHMARK(parallelConvertToDxfBench)->Apply(threadCounts);
+BENCHMARK_CAPTURE(writeDxfBench, native, DxfWriterKind::Native)->Apply(entityCounts);
+BENCHMARK_CAPTURE(writeDxfBench, libdxfrw, DxfWriterKind::Libdxfrw)->Apply(entityCounts);
+BENCHMARK(distanceSqrtBench);
+BENCHMARK_CAPTURE(distanceKernelBench, scalar, DistanceKernel::Scalar);
+BENCHMARK_CAPTURE(distanceKernelBench, sse2, DistanceKernel::Sse2);
+BENCHMARK_CAPTURE(distanceKernelBench, avx2, DistanceKernel::Avx2);
+BENCHMARK_CAPTURE(arcKernelBench, scalar, ArcKernel::Scalar);
+BENCHMARK_CAPTURE(arcKernelBench, sse2, ArcKernel::Sse2);
+BENCHMARK_CAPTURE(arcKernelBench, avx2, ArcKernel::Avx2);
+
+// Results are also written to dxf2jeo_bench.json, so that runs can be compared with tools/compare.py from Google Benchmark.
+// Any --benchmark_out or --benchmark_out_format argument overrides these defaults.
+int main(int argc, char** argv)
+{
+    auto arguments = std::vector<char*>{argv, argv + argc};
+    auto outPath   = std::string{"--benchmark_out=dxf2jeo_bench.json"};
+    auto outFormat = std::string{"--benchmark_out_format=json"};
+    arguments.insert(arguments.begin() + 1, {outPath.data(), outFormat.data()});
+
+    auto argumentCount = static_cast<int>(arguments.size());
+    benchmark::Initialize(&argumentCount, arguments.data());
+    if (benchmark::ReportUnrecognizedArguments(argumentCount, arguments.data()))
+        return 1;
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
\ No newline at end of file
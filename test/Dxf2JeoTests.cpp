@@ -1,18 +1,252 @@
+#include "ArcKernel.h"
+#include "ArcUtils.h"
+#include "Batch.h"
+#include "ConversionCache.h"
+#include "ConversionServer.h"
+#include "ConversionStats.h"
+#include "DistanceKernel.h"
 #include "Dxf2Jeo.h"
+#include "DxfGenerator.h"
 #include "DxfModel.h"
 #include "DxfReader.h"
 #include "DxfWriter.h"
+#include "InputFile.h"
 #include "Jeo2Dxf.h"
+#include "JeoBinary.h"
 #include "JeoModel.h"
+#include "JeoPointIndex.h"
 #include "JeoReader.h"
 #include "JeoWriter.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
 #include <gtest/gtest.h>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <thread>
+#include <tuple>
 
 namespace {
 
     std::filesystem::path getAssetDir() { return TEST_ASSET_DIR; }
 
+    std::optional<std::uint64_t> findPointByScan(const JeoPoints& points, const JeoPoint& point, double tolerance)
+    {
+        for (std::uint64_t i = 0, n = points.size(); i < n; ++i) {
+            const double dx = points[i].x - point.x;
+            const double dy = points[i].y - point.y;
+            const double dz = points[i].z - point.z;
+            if (std::sqrt(dx * dx + dy * dy + dz * dz) <= tolerance)
+                return i;
+        }
+        return std::nullopt;
+    }
+
+    DxfModel makeRandomDxfModel(std::uint64_t seed, std::uint64_t entityCount)
+    {
+        auto random = std::mt19937_64{seed};
+        auto grid   = std::uniform_int_distribution<int>{0, 40};
+        auto jitter = std::uniform_real_distribution<double>{-2e-3, 2e-3};
+        auto angle  = std::uniform_real_distribution<double>{-7., 7.};
+        auto color  = std::uniform_int_distribution<std::int64_t>{-1, 20};
+        auto tag    = std::uniform_int_distribution<int>{0, 30};
+        auto count  = std::uniform_int_distribution<int>{2, 6};
+
+        const auto randomCoord = [&]() { return DxfCoord{grid(random) * 1e-2 + jitter(random), grid(random) * 1e-2 + jitter(random), 0.}; };
+        const auto randomEntity = [&](DxfEntity& entity) {
+            if (const auto c = color(random); c >= 0)
+                entity.color = c;
+            if (const auto t = tag(random); t > 0)
+                entity.peURL = t == 1 ? "not a tag" : "TAG_" + std::to_string(t);
+        };
+
+        auto model = DxfModel{};
+        for (std::uint64_t i = 0; i < entityCount; ++i) {
+            auto line = DxfLine{};
+            randomEntity(line);
+            line.p1 = randomCoord();
+            line.p2 = randomCoord();
+            model.lines.push_back(line);
+
+            auto arc = DxfArc{};
+            randomEntity(arc);
+            arc.center = randomCoord();
+            arc.radius = grid(random) * 1e-2;
+            arc.theta1 = angle(random);
+            arc.theta2 = i % 7 == 0 ? arc.theta1 : angle(random);
+            model.arcs.push_back(arc);
+
+            auto entity = DxfEntity{};
+            randomEntity(entity);
+            auto coords = std::vector<DxfCoord>{};
+            for (int j = 0, n = count(random); j < n; ++j)
+                coords.push_back(randomCoord());
+            const auto bulges = std::vector<double>(coords.size(), 0.5);
+            model.polylines.push_back({entity, coords, i % 3 == 0 ? std::optional{ArrayView<double>{bulges}} : std::nullopt, i % 2 == 0});
+        }
+        return model;
+    }
+
+    void expectEqual(const JeoEntity& entity1, const JeoEntity& entity2)
+    {
+        EXPECT_EQ(entity1.colorIndex, entity2.colorIndex);
+        EXPECT_EQ(entity1.tagIndex, entity2.tagIndex);
+    }
+
+    void expectEqual(const JeoModel& model1, const JeoModel& model2)
+    {
+        ASSERT_EQ(model1.colors.size(), model2.colors.size());
+        for (std::uint64_t i = 0, n = model1.colors.size(); i < n; ++i) {
+            EXPECT_EQ(model1.colors[i].r, model2.colors[i].r);
+            EXPECT_EQ(model1.colors[i].g, model2.colors[i].g);
+            EXPECT_EQ(model1.colors[i].b, model2.colors[i].b);
+        }
+
+        EXPECT_EQ(model1.tags, model2.tags);
+
+        ASSERT_EQ(model1.points.size(), model2.points.size());
+        for (std::uint64_t i = 0, n = model1.points.size(); i < n; ++i) {
+            EXPECT_EQ(model1.points[i].x, model2.points[i].x);
+            EXPECT_EQ(model1.points[i].y, model2.points[i].y);
+            EXPECT_EQ(model1.points[i].z, model2.points[i].z);
+        }
+
+        ASSERT_EQ(model1.lines.size(), model2.lines.size());
+        for (std::uint64_t i = 0, n = model1.lines.size(); i < n; ++i) {
+            expectEqual(model1.lines[i], model2.lines[i]);
+            EXPECT_EQ(model1.lines[i].firstPointIndex, model2.lines[i].firstPointIndex);
+            EXPECT_EQ(model1.lines[i].lastPointIndex, model2.lines[i].lastPointIndex);
+        }
+
+        ASSERT_EQ(model1.arcs.size(), model2.arcs.size());
+        for (std::uint64_t i = 0, n = model1.arcs.size(); i < n; ++i) {
+            expectEqual(model1.arcs[i], model2.arcs[i]);
+            EXPECT_EQ(model1.arcs[i].centerIndex, model2.arcs[i].centerIndex);
+            EXPECT_EQ(model1.arcs[i].firstPointIndex, model2.arcs[i].firstPointIndex);
+            EXPECT_EQ(model1.arcs[i].lastPointIndex, model2.arcs[i].lastPointIndex);
+            EXPECT_EQ(model1.arcs[i].direct, model2.arcs[i].direct);
+        }
+
+        ASSERT_EQ(model1.polylines.size(), model2.polylines.size());
+        for (std::uint64_t i = 0, n = model1.polylines.size(); i < n; ++i) {
+            expectEqual(model1.polylines[i], model2.polylines[i]);
+            EXPECT_EQ(model1.polylines[i].pointIndexes, model2.polylines[i].pointIndexes);
+            EXPECT_EQ(model1.polylines[i].bulges, model2.polylines[i].bulges);
+            EXPECT_EQ(model1.polylines[i].closed, model2.polylines[i].closed);
+        }
+    }
+
+    // Compares models up to the numbering of their points, colors and tags
+    void expectEquivalent(const JeoModel& model1, const JeoEntity& entity1, const JeoModel& model2, const JeoEntity& entity2)
+    {
+        ASSERT_EQ(entity1.colorIndex.has_value(), entity2.colorIndex.has_value());
+        if (entity1.colorIndex) {
+            const auto& color1 = model1.colors.at(*entity1.colorIndex);
+            const auto& color2 = model2.colors.at(*entity2.colorIndex);
+            EXPECT_EQ(std::tie(color1.r, color1.g, color1.b), std::tie(color2.r, color2.g, color2.b));
+        }
+        ASSERT_EQ(entity1.tagIndex.has_value(), entity2.tagIndex.has_value());
+        if (entity1.tagIndex) {
+            EXPECT_EQ(model1.tags.at(*entity1.tagIndex), model2.tags.at(*entity2.tagIndex));
+        }
+    }
+
+    void expectEquivalent(const JeoModel& model1, std::uint64_t pointIndex1, const JeoModel& model2, std::uint64_t pointIndex2)
+    {
+        // Both points are within tolerance of the same original coordinate
+        const auto& point1 = model1.points.at(pointIndex1);
+        const auto& point2 = model2.points.at(pointIndex2);
+        EXPECT_LE(std::hypot(point1.x - point2.x, point1.y - point2.y, point1.z - point2.z), 2e-3);
+    }
+
+    void expectEquivalent(const JeoModel& model1, const JeoModel& model2)
+    {
+        ASSERT_EQ(model1.lines.size(), model2.lines.size());
+        for (std::uint64_t i = 0, n = model1.lines.size(); i < n; ++i) {
+            expectEquivalent(model1, model1.lines[i], model2, model2.lines[i]);
+            expectEquivalent(model1, model1.lines[i].firstPointIndex, model2, model2.lines[i].firstPointIndex);
+            expectEquivalent(model1, model1.lines[i].lastPointIndex, model2, model2.lines[i].lastPointIndex);
+        }
+
+        ASSERT_EQ(model1.arcs.size(), model2.arcs.size());
+        for (std::uint64_t i = 0, n = model1.arcs.size(); i < n; ++i) {
+            expectEquivalent(model1, model1.arcs[i], model2, model2.arcs[i]);
+            expectEquivalent(model1, model1.arcs[i].centerIndex, model2, model2.arcs[i].centerIndex);
+            expectEquivalent(model1, model1.arcs[i].firstPointIndex, model2, model2.arcs[i].firstPointIndex);
+            expectEquivalent(model1, model1.arcs[i].lastPointIndex, model2, model2.arcs[i].lastPointIndex);
+            EXPECT_EQ(model1.arcs[i].direct, model2.arcs[i].direct);
+        }
+
+        ASSERT_EQ(model1.polylines.size(), model2.polylines.size());
+        for (std::uint64_t i = 0, n = model1.polylines.size(); i < n; ++i) {
+            expectEquivalent(model1, model1.polylines[i], model2, model2.polylines[i]);
+            ASSERT_EQ(model1.polylines[i].pointIndexes.size(), model2.polylines[i].pointIndexes.size());
+            for (std::uint64_t j = 0, m = model1.polylines[i].pointIndexes.size(); j < m; ++j)
+                expectEquivalent(model1, model1.polylines[i].pointIndexes[j], model2, model2.polylines[i].pointIndexes[j]);
+            EXPECT_EQ(model1.polylines[i].bulges, model2.polylines[i].bulges);
+            EXPECT_EQ(model1.polylines[i].closed, model2.polylines[i].closed);
+        }
+    }
+
+    void expectEqual(const DxfCoord& coord1, const DxfCoord& coord2)
+    {
+        EXPECT_EQ(coord1.x, coord2.x);
+        EXPECT_EQ(coord1.y, coord2.y);
+        EXPECT_EQ(coord1.z, coord2.z);
+    }
+
+    void expectEqual(const DxfEntity& entity1, const DxfEntity& entity2)
+    {
+        EXPECT_EQ(entity1.layer, entity2.layer);
+        EXPECT_EQ(entity1.color, entity2.color);
+        EXPECT_EQ(entity1.peURL, entity2.peURL);
+    }
+
+    void expectEqual(const std::vector<DxfLayer>& layers1, const std::vector<DxfLayer>& layers2)
+    {
+        ASSERT_EQ(layers1.size(), layers2.size());
+        for (std::uint64_t i = 0, n = layers1.size(); i < n; ++i) {
+            EXPECT_EQ(layers1[i].name, layers2[i].name);
+            EXPECT_EQ(layers1[i].color, layers2[i].color);
+        }
+    }
+
+    void expectEqual(const DxfModel& model1, const DxfModel& model2)
+    {
+        ASSERT_EQ(model1.lines.size(), model2.lines.size());
+        for (std::uint64_t i = 0, n = model1.lines.size(); i < n; ++i) {
+            expectEqual(model1.lines[i], model2.lines[i]);
+            expectEqual(model1.lines[i].p1, model2.lines[i].p1);
+            expectEqual(model1.lines[i].p2, model2.lines[i].p2);
+        }
+
+        ASSERT_EQ(model1.arcs.size(), model2.arcs.size());
+        for (std::uint64_t i = 0, n = model1.arcs.size(); i < n; ++i) {
+            expectEqual(model1.arcs[i], model2.arcs[i]);
+            expectEqual(model1.arcs[i].center, model2.arcs[i].center);
+            EXPECT_EQ(model1.arcs[i].radius, model2.arcs[i].radius);
+            EXPECT_EQ(model1.arcs[i].theta1, model2.arcs[i].theta1);
+            EXPECT_EQ(model1.arcs[i].theta2, model2.arcs[i].theta2);
+        }
+
+        const auto& polylines1 = model1.polylines;
+        const auto& polylines2 = model2.polylines;
+        ASSERT_EQ(polylines1.size(), polylines2.size());
+        for (std::uint64_t i = 0, n = polylines1.size(); i < n; ++i) {
+            expectEqual(polylines1.entities[i], polylines2.entities[i]);
+            EXPECT_EQ(polylines1[i].closed, polylines2[i].closed);
+            EXPECT_EQ(polylines1[i].bulges, polylines2[i].bulges);
+            ASSERT_EQ(polylines1[i].coords.size(), polylines2[i].coords.size());
+            for (std::uint64_t j = 0, m = polylines1[i].coords.size(); j < m; ++j)
+                expectEqual(polylines1[i].coords[j], polylines2[i].coords[j]);
+        }
+    }
+
     TEST(dxf2jeotests, test1)
     {
         const auto inputPath = getAssetDir() / "test1.jeo";
@@ -56,4 +290,830 @@ namespace {
         ASSERT_EQ(jeoModel.polylines[0].bulges->size(), 4);
         ASSERT_NEAR(jeoModel.polylines[0].bulges->at(2), 1., 1e-15);
     }
+
+    TEST(dxf2jeotests, pointIndexMatchesLinearScan)
+    {
+        constexpr auto TOLERANCE = 1e-3;
+
+        auto random = std::mt19937_64{42};
+        auto grid   = std::uniform_int_distribution<int>{-20, 20};
+        auto jitter = std::uniform_real_distribution<double>{-1.5 * TOLERANCE, 1.5 * TOLERANCE};
+        auto layer  = std::uniform_int_distribution<int>{0, 3};
+
+        auto points     = JeoPoints{};
+        auto pointIndex = JeoPointIndex{TOLERANCE};
+        for (int i = 0; i < 20000; ++i) {
+            const auto x     = grid(random) * 2.5 * TOLERANCE + jitter(random);
+            const auto y     = grid(random) * 2.5 * TOLERANCE + jitter(random);
+            const auto z     = layer(random) == 0 ? jitter(random) : 0.;
+            const auto point = JeoPoint{x, y, z};
+
+            const auto expected = findPointByScan(points, point, TOLERANCE);
+            const auto actual   = pointIndex.find(points, point);
+            ASSERT_EQ(actual, expected);
+
+            if (!actual) {
+                pointIndex.insert(point, points.size());
+                points.push_back(point);
+            }
+        }
+    }
+
+    // Thousands of jittered endpoints meeting at a few nodes, some within tolerance of each other and some spread over several points
+    TEST(dxf2jeotests, weldPointsMatchesPointIndexOnDenseClusters)
+    {
+        constexpr auto TOLERANCE = 1e-3;
+
+        auto random = std::mt19937_64{17};
+        auto node   = std::uniform_int_distribution<int>{0, 3};
+        auto tight  = std::uniform_real_distribution<double>{-0.3 * TOLERANCE, 0.3 * TOLERANCE};
+        auto spread = std::uniform_real_distribution<double>{-3 * TOLERANCE, 3 * TOLERANCE};
+
+        auto coords = JeoPoints{};
+        for (int i = 0; i < 20000; ++i) {
+            const auto nodeIndex = node(random);
+            auto&      jitter    = nodeIndex < 2 ? tight : spread;
+            coords.push_back({nodeIndex * 0.1 + jitter(random), 1. + jitter(random), 0.});
+        }
+
+        auto expected   = JeoWeldedPoints{};
+        auto pointIndex = JeoPointIndex{TOLERANCE};
+        for (std::uint64_t i = 0, n = coords.size(); i < n; ++i) {
+            const auto found = pointIndex.find(expected.points, coords[i]);
+            if (!found) {
+                pointIndex.insert(coords[i], expected.points.size());
+                expected.points.push_back(coords[i]);
+            }
+            expected.pointIndexes.push_back(found.value_or(expected.points.size() - 1));
+        }
+
+        for (const auto threadCount : {1, 2, 3, 8}) {
+            const auto actual = weldPoints(coords, TOLERANCE, threadCount);
+            ASSERT_EQ(actual.pointIndexes, expected.pointIndexes);
+            ASSERT_EQ(actual.points.size(), expected.points.size());
+            for (std::uint64_t i = 0, n = expected.points.size(); i < n; ++i) {
+                EXPECT_EQ(actual.points[i].x, expected.points[i].x);
+                EXPECT_EQ(actual.points[i].y, expected.points[i].y);
+            }
+        }
+    }
+
+    TEST(dxf2jeotests, distanceKernelsMatchSqrtTest)
+    {
+        for (const auto tolerance : {1e-3, 1e-6, 0.1, 1.0, 3.0, 1e3}) {
+            const auto squaredTolerance = toSquaredTolerance(tolerance);
+            EXPECT_LE(std::sqrt(squaredTolerance), tolerance);
+            EXPECT_GT(std::sqrt(std::nextafter(squaredTolerance, HUGE_VAL)), tolerance);
+        }
+
+        constexpr auto TOLERANCE = 1e-3;
+        const auto     origin    = JeoPoint{1.5, -2.25, 0.125};
+
+        // Candidates straddling the tolerance along each axis and the diagonal, then special values, then random ones
+        auto candidates = JeoPoints{};
+        for (const auto& direction : {JeoPoint{1, 0, 0}, JeoPoint{0, -1, 0}, JeoPoint{0, 0, 1}, JeoPoint{0.6, 0.8, 0}}) {
+            auto distance = TOLERANCE;
+            for (int i = 0; i < 4; ++i)
+                distance = std::nextafter(distance, 0.);
+            for (int i = 0; i < 8; ++i, distance = std::nextafter(distance, 1.))
+                candidates.push_back({origin.x + direction.x * distance, origin.y + direction.y * distance, origin.z + direction.z * distance});
+        }
+        const auto nan = std::numeric_limits<double>::quiet_NaN();
+        const auto inf = std::numeric_limits<double>::infinity();
+        candidates.push_back({nan, origin.y, origin.z});
+        candidates.push_back({origin.x, inf, origin.z});
+        candidates.push_back({-inf, -inf, -inf});
+        candidates.push_back({-0., 0., 0.});
+        candidates.push_back(origin);
+        auto random = std::mt19937_64{42};
+        auto jitter = std::uniform_real_distribution<double>{-1.5 * TOLERANCE, 1.5 * TOLERANCE};
+        while (candidates.size() < 3 * DISTANCE_BLOCK_SIZE)
+            candidates.push_back({origin.x + jitter(random), origin.y + jitter(random), origin.z + jitter(random)});
+
+        const auto squaredTolerance = toSquaredTolerance(TOLERANCE);
+        for (const auto kernel : {DistanceKernel::Scalar, DistanceKernel::Sse2, DistanceKernel::Avx2}) {
+            if (!isSupported(kernel))
+                continue;
+
+            // Every block offset and length, so that the vector loops and their scalar tails both meet each candidate
+            for (std::uint64_t begin = 0; begin < 2 * DISTANCE_BLOCK_SIZE; begin += 7) {
+                for (std::uint64_t count = 0; count <= DISTANCE_BLOCK_SIZE; ++count) {
+                    const auto* x       = candidates.x.data() + begin;
+                    const auto* y       = candidates.y.data() + begin;
+                    const auto* z       = candidates.z.data() + begin;
+                    const auto  matches = matchWithinTolerance(kernel, x, y, z, count, origin, squaredTolerance);
+                    for (std::uint64_t i = 0; i < DISTANCE_BLOCK_SIZE; ++i) {
+                        const auto dx       = x[i] - origin.x;
+                        const auto dy       = y[i] - origin.y;
+                        const auto dz       = z[i] - origin.z;
+                        const auto expected = i < count && std::sqrt(dx * dx + dy * dy + dz * dz) <= TOLERANCE;
+                        ASSERT_EQ(((matches >> i) & 1) != 0, expected) << static_cast<int>(kernel) << " " << begin << " " << count << " " << i;
+                    }
+                }
+            }
+        }
+        const auto tooMany = DISTANCE_BLOCK_SIZE + 1;
+        EXPECT_THROW(matchWithinTolerance(DistanceKernel::Scalar, nullptr, nullptr, nullptr, tooMany, origin, squaredTolerance), std::runtime_error);
+    }
+
+    TEST(dxf2jeotests, arcKernelsMatchScalarTest)
+    {
+        // Offsets along the axes with signed zeros, around the bounds of the arc tangent reductions, then special values, then random ones
+        auto offsets = std::vector<std::pair<double, double>>{};
+        for (const auto axis : {1., -1., 0., -0.})
+            for (const auto other : {0., -0.})
+                offsets.emplace_back(axis, other), offsets.emplace_back(other, axis);
+        for (const auto ratio : {0.66, 2.41421356237309504880, 1.})
+            for (const auto sign : {1., -1.})
+                for (auto value = ratio, i = 0.; i < 3; ++i, value = std::nextafter(value, 3.))
+                    offsets.emplace_back(sign * 3., sign * 3. * value), offsets.emplace_back(-sign * 3. * value, sign * 3.);
+        const auto nan = std::numeric_limits<double>::quiet_NaN();
+        const auto inf = std::numeric_limits<double>::infinity();
+        for (const auto special : {nan, inf, -inf, 1e-160, 1e200, -1e-300})
+            offsets.emplace_back(special, 1.), offsets.emplace_back(-2., special), offsets.emplace_back(special, special);
+        const auto pi     = std::atan(1.) * 4;
+        auto       random = std::mt19937_64{42};
+        auto       angle  = std::uniform_real_distribution<double>{-pi, pi};
+        auto       scale  = std::uniform_real_distribution<double>{-12., 12.};
+        while (offsets.size() < 40 * ARC_BLOCK_SIZE) {
+            const auto theta  = angle(random);
+            const auto radius = std::pow(10., scale(random));
+            offsets.emplace_back(radius * std::cos(theta), radius * std::sin(theta));
+        }
+
+        // Arcs made of consecutive offsets, blocks being filled to every size so that the vector loops and their scalar tails meet each one
+        const auto fillBlock = [&](ArcBlock& block, std::uint64_t begin, std::uint64_t size) {
+            block.size = size;
+            for (std::uint64_t i = 0; i < size; ++i) {
+                std::tie(block.firstDx[i], block.firstDy[i]) = offsets[(begin + i) % offsets.size()];
+                std::tie(block.lastDx[i], block.lastDy[i])   = offsets[(begin + i + 1) % offsets.size()];
+            }
+        };
+        const auto expectNear = [](double value, double expected, double tolerance) {
+            if (std::isnan(expected))
+                return std::isnan(value);
+            return value == expected || std::fabs(value - expected) <= tolerance;
+        };
+        for (const auto kernel : {ArcKernel::Sse2, ArcKernel::Avx2}) {
+            if (!isSupported(kernel))
+                continue;
+
+            auto block    = ArcBlock{};
+            auto expected = ArcBlock{};
+            for (std::uint64_t begin = 0; begin < offsets.size(); begin += 17) {
+                const auto size = begin % (ARC_BLOCK_SIZE + 1);
+                fillBlock(block, begin, size);
+                fillBlock(expected, begin, size);
+                evaluateArcs(kernel, block);
+                evaluateArcs(ArcKernel::Scalar, expected);
+                for (std::uint64_t i = 0; i < size; ++i) {
+                    ASSERT_TRUE(expectNear(block.radius[i], expected.radius[i], 1e-12 * expected.radius[i])) << static_cast<int>(kernel) << " " << begin + i;
+                    ASSERT_TRUE(expectNear(block.theta1[i], expected.theta1[i], 1e-12)) << static_cast<int>(kernel) << " " << begin + i;
+                    ASSERT_TRUE(expectNear(block.theta2[i], expected.theta2[i], 1e-12)) << static_cast<int>(kernel) << " " << begin + i;
+                }
+            }
+        }
+        auto tooMany = ArcBlock{};
+        tooMany.size = ARC_BLOCK_SIZE + 1;
+        EXPECT_THROW(evaluateArcs(ArcKernel::Scalar, tooMany), std::runtime_error);
+    }
+
+    TEST(dxf2jeotests, parallelConversionMatchesSequential)
+    {
+        const auto dxfModel = makeRandomDxfModel(7, 3000);
+        const auto expected = convertToJeo(dxfModel);
+        for (const auto threadCount : {2, 3, 8}) {
+            const auto actual = convertToJeo(dxfModel, threadCount);
+            expectEqual(actual, expected);
+        }
+    }
+
+    TEST(dxf2jeotests, parallelDxfConversionMatchesSequential)
+    {
+        const auto jeoModel = convertToJeo(makeRandomDxfModel(13, 3000));
+        const auto expected = convertToDxf(jeoModel);
+        for (const auto threadCount : {2, 3, 8})
+            expectEqual(convertToDxf(jeoModel, threadCount), expected);
+
+        const auto singlePoint  = std::vector<std::uint64_t>{0};
+        auto       invalidModel = jeoModel;
+        invalidModel.polylines.push_back({{}, ArrayView<std::uint64_t>{singlePoint}, std::nullopt, false});
+        EXPECT_THROW(convertToDxf(invalidModel, 4), std::runtime_error);
+    }
+
+    // Entities of the random model are on a layer missing from the file, which leaves their colors as they are when read back
+    TEST(dxf2jeotests, nativeDxfWriterRoundTrips)
+    {
+        auto model   = makeRandomDxfModel(17, 500);
+        model.layers = {{"walls", 3}, {"doors", 0}};
+
+        auto line  = DxfLine{};
+        line.layer = "walls";
+        line.peURL = "TAG_42";
+        line.p1    = {1.5, -2., 3.};
+        line.p2    = {-1e-9, 4e12, 3.};
+        model.lines.push_back(line);
+        const auto coords = std::vector<DxfCoord>{{0., 0., 2.5}, {1., 0., 2.5}, {1., 1., 2.5}};
+        const auto bulges = std::vector<double>{0., -0.75, 0.};
+        model.polylines.push_back({line, coords, ArrayView<double>{bulges}, true});
+
+        const auto outputPath = std::filesystem::temp_directory_path() / "dxf2jeo_native_writer_test.dxf";
+        writeDxf(model, outputPath, DxfWriterKind::Native);
+        auto actual = readDxf(outputPath);
+
+        // Layer 0 is added, ByLayer colors are resolved and angles come back in [0, 2PI) through degrees
+        auto expected = model;
+        expected.layers.push_back({"0", 7});
+        expected.lines.back().color              = 3;
+        expected.polylines.entities.back().color = 3;
+        expectEqual(actual.layers, expected.layers);
+        ASSERT_EQ(actual.arcs.size(), expected.arcs.size());
+        for (std::uint64_t i = 0, n = expected.arcs.size(); i < n; ++i) {
+            auto& arc = expected.arcs[i];
+            normalize(arc.theta1, arc.theta2, true);
+            EXPECT_NEAR(actual.arcs[i].theta1, arc.theta1, 1e-12);
+            EXPECT_NEAR(actual.arcs[i].theta2, arc.theta2, 1e-12);
+            actual.arcs[i].theta1 = arc.theta1;
+            actual.arcs[i].theta2 = arc.theta2;
+        }
+        expectEqual(actual, expected);
+        std::filesystem::remove(outputPath);
+    }
+
+    TEST(dxf2jeotests, cursorReaderMatchesDomReader)
+    {
+        for (const auto* fileName : {"test1.jeo", "test2.jeo"}) {
+            const auto inputPath = getAssetDir() / fileName;
+            expectEqual(readJeo(inputPath), readJeoDom(inputPath));
+        }
+    }
+
+    TEST(dxf2jeotests, polylinesShareFlatArrays)
+    {
+        const auto pointIndexes = std::vector<std::uint64_t>{0, 1, 2, 3, 4, 5};
+        const auto bulges       = std::vector<double>{0.5, -0.25, 0.};
+
+        auto model = JeoModel{};
+        for (const auto& point : {JeoPoint{0, 0, 0}, JeoPoint{1, 0, 0}, JeoPoint{1, 1, 0}, JeoPoint{0, 1, 0}, JeoPoint{2, 2, 0}, JeoPoint{3, 2, 0}})
+            model.points.push_back(point);
+        model.polylines.push_back({{}, ArrayView<std::uint64_t>{pointIndexes.data(), 3}, std::nullopt, false});
+        model.polylines.push_back({{std::nullopt, std::nullopt}, ArrayView<std::uint64_t>{pointIndexes.data() + 3, 3}, ArrayView<double>{bulges}, true});
+        model.polylines.push_back({{}, {}, ArrayView<double>{}, false});
+        model.polylines.push_back({{}, ArrayView<std::uint64_t>{pointIndexes.data() + 4, 2}, std::nullopt, true});
+
+        const auto& polylines = model.polylines;
+        EXPECT_EQ(polylines.pointIndexes, (std::vector<std::uint64_t>{0, 1, 2, 3, 4, 5, 4, 5}));
+        EXPECT_EQ(polylines.pointOffsets, (std::vector<std::uint64_t>{0, 3, 6, 6, 8}));
+        EXPECT_EQ(polylines.bulges, bulges);
+        EXPECT_EQ(polylines.bulgeOffsets, (std::vector<std::uint64_t>{0, 0, 3, 3, 3}));
+        EXPECT_EQ(polylines[1].pointIndexes, (ArrayView<std::uint64_t>{pointIndexes.data() + 3, 3}));
+        EXPECT_EQ(polylines[1].bulges, ArrayView<double>{bulges});
+        EXPECT_FALSE(polylines[0].bulges);
+        EXPECT_TRUE(polylines[2].bulges && polylines[2].bulges->empty());
+        EXPECT_TRUE(polylines[3].closed);
+        EXPECT_THROW(polylines.at(4), std::out_of_range);
+
+        const auto outputPath = std::filesystem::temp_directory_path() / "dxf2jeo_polylines_test.jeo";
+        writeJeo(model, outputPath);
+        expectEqual(readJeo(outputPath), model);
+        expectEqual(readJeoDom(outputPath), model);
+        EXPECT_EQ(readJeo(outputPath).polylines.bulgeOffsets, polylines.bulgeOffsets);
+        std::filesystem::remove(outputPath);
+    }
+
+    TEST(dxf2jeotests, inputFileMatchesStreamRead)
+    {
+        for (const auto* fileName : {"test1.jeo", "test3.dxf"}) {
+            const auto inputPath = getAssetDir() / fileName;
+            auto       in        = std::ifstream{inputPath, std::ios::binary};
+            const auto expected  = std::string{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+
+            for (const auto access : {InputFileAccess::Random, InputFileAccess::Sequential}) {
+                const auto inputFile = InputFile{inputPath, access};
+                ASSERT_EQ(inputFile.contents(), expected);
+            }
+        }
+    }
+
+    TEST(dxf2jeotests, binaryJeoMatchesJsonJeo)
+    {
+        const auto outputPath = std::filesystem::temp_directory_path() / "dxf2jeo_binary_test.jeob";
+
+        auto models = std::vector<JeoModel>{readJeo(getAssetDir() / "test1.jeo"), readJeo(getAssetDir() / "test2.jeo")};
+        models.push_back(convertToJeo(makeRandomDxfModel(11, 2000)));
+        models.back().polylines.push_back(JeoPolyline{{}, {}, ArrayView<double>{}, true});
+        for (const auto& expected : models) {
+            writeJeo(expected, outputPath);
+            expectEqual(readJeo(outputPath), expected);
+
+            const auto view = JeoBinaryView{outputPath};
+            ASSERT_EQ(view.pointsX().size(), expected.points.size());
+            for (std::uint64_t i = 0, n = expected.points.size(); i < n; ++i) {
+                ASSERT_EQ(view.pointsX()[i], expected.points[i].x);
+                ASSERT_EQ(view.pointsY()[i], expected.points[i].y);
+                ASSERT_EQ(view.pointsZ()[i], expected.points[i].z);
+            }
+            ASSERT_EQ(view.polylines().size(), expected.polylines.size());
+            for (std::uint64_t i = 0, n = expected.polylines.size(); i < n; ++i) {
+                const auto pointIndexes         = view.polylinePoints(i);
+                const auto expectedPointIndexes = expected.polylines[i].pointIndexes;
+                ASSERT_TRUE(std::equal(pointIndexes.begin(), pointIndexes.end(), expectedPointIndexes.begin(), expectedPointIndexes.end()));
+            }
+        }
+        std::filesystem::remove(outputPath);
+    }
+
+    TEST(dxf2jeotests, jsonJeoRoundTripsDoubles)
+    {
+        const auto outputPath = std::filesystem::temp_directory_path() / "dxf2jeo_round_trip_test.jeo";
+
+        auto bits = std::mt19937_64{5};
+        auto hard = JeoModel{};
+        hard.points.push_back(JeoPoint{0.1, -0.0, 5e-324});
+        hard.points.push_back(JeoPoint{1e300, -2.2250738585072014e-308, 123456789012345678.0});
+        for (int i = 0; i < 1000; ++i) {
+            auto coordinates = std::array<double, 3>{};
+            for (auto& coordinate : coordinates) {
+                const auto value = bits();
+                std::memcpy(&coordinate, &value, sizeof(value));
+                if (!std::isfinite(coordinate))
+                    coordinate = 0.5;
+            }
+            hard.points.push_back(JeoPoint{coordinates[0], coordinates[1], coordinates[2]});
+        }
+
+        for (const auto* fileName : {"test1.jeo", "test2.jeo"}) {
+            const auto inputPath = getAssetDir() / fileName;
+            const auto expected  = readJeo(inputPath);
+            writeJeo(expected, outputPath);
+            expectEqual(readJeo(outputPath), expected);
+            expectEqual(readJeoDom(outputPath), expected);
+            EXPECT_LT(std::filesystem::file_size(outputPath), std::filesystem::file_size(inputPath));
+        }
+
+        writeJeo(hard, outputPath);
+        const auto actual = readJeo(outputPath);
+        ASSERT_EQ(actual.points.size(), hard.points.size());
+        for (std::uint64_t i = 0, n = hard.points.size(); i < n; ++i) {
+            const auto actualPoint = actual.points[i];
+            const auto hardPoint   = hard.points[i];
+            EXPECT_EQ(std::memcmp(&actualPoint, &hardPoint, sizeof(JeoPoint)), 0);
+        }
+        std::filesystem::remove(outputPath);
+    }
+
+    TEST(dxf2jeotests, streamingConversionMatchesConvertToJeo)
+    {
+        const auto dxfModel = makeRandomDxfModel(13, 2000);
+        const auto expected = convertToJeo(dxfModel);
+
+        auto converter = Dxf2JeoConverter{};
+        for (const auto& line : dxfModel.lines)
+            converter.addLine(line);
+        for (const auto& arc : dxfModel.arcs)
+            converter.addArc(arc);
+        for (std::uint64_t i = 0, n = dxfModel.polylines.size(); i < n; ++i)
+            converter.addPolyline(dxfModel.polylines[i]);
+        expectEqual(converter.takeModel(), expected);
+
+        for (std::uint64_t i = 0, n = dxfModel.lines.size(); i < n; ++i) {
+            converter.addPolyline(dxfModel.polylines[i]);
+            converter.addArc(dxfModel.arcs[i]);
+            converter.addLine(dxfModel.lines[i]);
+        }
+        expectEquivalent(converter.takeModel(), expected);
+    }
+
+    TEST(dxf2jeotests, streamingReadMatchesModelRead)
+    {
+        auto converter = Dxf2JeoConverter{};
+        for (const auto* fileName : {"test3.dxf", "test4.dxf"}) {
+            const auto inputPath = getAssetDir() / fileName;
+            readDxf(inputPath, converter);
+            expectEquivalent(converter.takeModel(), convertToJeo(readDxf(inputPath)));
+        }
+    }
+
+    TEST(dxf2jeotests, nativeDxfReaderMatchesLibdxfrw)
+    {
+        const auto writtenPath = std::filesystem::temp_directory_path() / "dxf2jeo_native_reader_test.dxf";
+        auto       model       = makeRandomDxfModel(19, 500);
+        model.layers           = {{"walls", 3}};
+
+        for (const auto writerKind : {DxfWriterKind::Native, DxfWriterKind::Libdxfrw}) {
+            writeDxf(model, writtenPath, writerKind);
+            for (const auto& inputPath : {getAssetDir() / "test3.dxf", getAssetDir() / "test4.dxf", writtenPath}) {
+                const auto expected = readDxf(inputPath, DxfReaderKind::Libdxfrw);
+                const auto actual   = readDxf(inputPath, DxfReaderKind::Native);
+                expectEqual(actual.layers, expected.layers);
+                expectEqual(actual, expected);
+
+                auto converter = Dxf2JeoConverter{};
+                readDxf(inputPath, converter, DxfReaderKind::Native);
+                expectEquivalent(converter.takeModel(), convertToJeo(expected));
+            }
+        }
+        std::filesystem::remove(writtenPath);
+    }
+
+    TEST(dxf2jeotests, nativeDxfReaderParsesGroups)
+    {
+        // Numbers are padded, comments, application groups, skipped sections and entities are mixed in, lines ending with \r\n
+        const auto groups = std::string_view{R"(999
+comment
+  0
+SECTION
+  2
+HEADER
+  9
+$ACADVER
+  1
+AC1027
+  0
+ENDSEC
+  0
+SECTION
+  2
+TABLES
+  0
+TABLE
+  2
+LAYER
+ 70
+1
+  0
+LAYER
+  2
+walls
+ 62
+  3
+  0
+ENDTAB
+  0
+ENDSEC
+  0
+SECTION
+  2
+ENTITIES
+  0
+LINE
+102
+{ACAD_REACTORS
+  8
+ignored
+102
+}
+  8
+walls
+ 10
+ +1.5
+ 20
+-2
+ 11
+3e2
+ 21
+4
+1001
+OTHER
+1000
+not a tag
+1001
+PE_URL
+1000
+TAG_1
+  0
+CIRCLE
+ 10
+1
+ 40
+1
+  0
+ARC
+  8
+doors
+ 10
+1
+ 20
+2
+ 40
+0.5
+ 50
+90
+ 51
+180
+  0
+LWPOLYLINE
+ 62
+5
+ 90
+2
+ 70
+1
+ 38
+2.5
+ 10
+0
+ 20
+0
+ 42
+0.5
+ 10
+1
+ 20
+1
+  0
+ENDSEC
+  0
+EOF
+)"};
+        const auto inputPath = std::filesystem::temp_directory_path() / "dxf2jeo_native_groups_test.dxf";
+        {
+            auto file = std::ofstream{inputPath, std::ios::binary};
+            for (const auto c : groups)
+                file << (c == '\n' ? "\r\n" : std::string(1, c));
+        }
+        const auto model = readDxf(inputPath, DxfReaderKind::Native);
+
+        expectEqual(model.layers, {{"walls", 3}});
+        ASSERT_EQ(model.lines.size(), 1);
+        EXPECT_EQ(model.lines[0].layer, "walls");
+        EXPECT_EQ(model.lines[0].color, 3);
+        EXPECT_EQ(model.lines[0].peURL, "TAG_1");
+        expectEqual(model.lines[0].p1, {1.5, -2., 0.});
+        expectEqual(model.lines[0].p2, {300., 4., 0.});
+
+        ASSERT_EQ(model.arcs.size(), 1);
+        EXPECT_EQ(model.arcs[0].layer, "doors");
+        EXPECT_FALSE(model.arcs[0].color);
+        expectEqual(model.arcs[0].center, {1., 2., 0.});
+        EXPECT_EQ(model.arcs[0].radius, 0.5);
+        EXPECT_NEAR(model.arcs[0].theta1, std::atan(1.) * 2, 1e-15);
+        EXPECT_NEAR(model.arcs[0].theta2, std::atan(1.) * 4, 1e-15);
+
+        ASSERT_EQ(model.polylines.size(), 1);
+        const auto polyline = model.polylines[0];
+        EXPECT_EQ(polyline.entity.layer, "0");
+        EXPECT_EQ(polyline.entity.color, 5);
+        EXPECT_TRUE(polyline.closed);
+        ASSERT_EQ(polyline.coords.size(), 2);
+        expectEqual(polyline.coords[0], {0., 0., 2.5});
+        expectEqual(polyline.coords[1], {1., 1., 2.5});
+        const auto bulges = std::vector<double>{0.5, 0.};
+        EXPECT_EQ(polyline.bulges, ArrayView<double>{bulges});
+
+        for (const auto* contents : {"AutoCAD Binary DXF\r\n", "  x\nLINE\n", "  0\nSECTION\n  2\nENTITIES\n  0\nLINE\n 10\nabc\n", "  0\n"}) {
+            std::ofstream{inputPath, std::ios::binary} << contents;
+            EXPECT_THROW(readDxf(inputPath, DxfReaderKind::Native), std::runtime_error);
+        }
+        std::filesystem::remove(inputPath);
+    }
+
+    // Entities of the random model are on the only layer, so that ByLayer colors come from the tables read beforehand.
+    // A tag reading ENDSEC must not be taken for the end of the section when splitting it.
+    TEST(dxf2jeotests, parallelNativeDxfReadMatchesSequential)
+    {
+        const auto writtenPath  = std::filesystem::temp_directory_path() / "dxf2jeo_parallel_read_test.dxf";
+        auto       model        = makeRandomDxfModel(23, 2000);
+        model.layers            = {{"", 4}};
+        model.lines[1000].peURL = "ENDSEC";
+        writeDxf(model, writtenPath, DxfWriterKind::Native);
+
+        for (const auto& inputPath : {getAssetDir() / "test3.dxf", getAssetDir() / "test4.dxf", writtenPath}) {
+            const auto expected = readDxf(inputPath, DxfReaderKind::Native);
+            for (const auto threadCount : {2, 3, 8, 64}) {
+                const auto actual = readDxf(inputPath, DxfReaderKind::Native, threadCount);
+                expectEqual(actual.layers, expected.layers);
+                expectEqual(actual, expected);
+            }
+        }
+
+        const auto written = readDxf(writtenPath, DxfReaderKind::Native, 8);
+        ASSERT_EQ(written.lines.size(), 2000);
+        EXPECT_EQ(written.lines[0].color, model.lines[0].color.value_or(4));
+        EXPECT_EQ(written.lines[1999].color, model.lines[1999].color.value_or(4));
+        EXPECT_EQ(written.lines[1000].peURL, "ENDSEC");
+        std::filesystem::remove(writtenPath);
+    }
+
+    TEST(dxf2jeotests, generatorFollowsOptionsAndSeed)
+    {
+        auto options             = DxfGeneratorOptions{};
+        options.seed             = 3;
+        options.lineCount        = 200;
+        options.arcCount         = 100;
+        options.polylineCount    = 50;
+        options.vertexCount      = 5;
+        options.sharedPointRatio = 0.;
+        options.bulgeRatio       = 1.;
+        options.layerCount       = 4;
+        options.colorCount       = 10;
+        options.tagCount         = 5;
+
+        const auto dxfModel = generateDxfModel(options);
+        EXPECT_EQ(dxfModel.layers.size(), 4u);
+        EXPECT_EQ(dxfModel.lines.size(), 200u);
+        EXPECT_EQ(dxfModel.arcs.size(), 100u);
+        ASSERT_EQ(dxfModel.polylines.size(), 50u);
+        for (std::uint64_t i = 0, n = dxfModel.polylines.size(); i < n; ++i) {
+            EXPECT_EQ(dxfModel.polylines[i].coords.size(), 5u);
+            EXPECT_TRUE(dxfModel.polylines[i].bulges);
+        }
+        EXPECT_EQ(dxfModel.polylines.coords.size(), 50u * 5);
+        EXPECT_EQ(dxfModel.polylines.bulges.size(), 50u * 5);
+        for (const auto& line : dxfModel.lines) {
+            EXPECT_TRUE(line.color >= 1 && line.color <= 10);
+            EXPECT_TRUE(line.peURL);
+        }
+
+        // Values only depend on the mt19937_64 outputs, which the standard specifies, so they are the same on every platform
+        EXPECT_EQ(dxfModel.lines[0].p1.x, 559.79563654389847);
+        EXPECT_EQ(dxfModel.lines[0].p1.y, 361.30268965844158);
+        EXPECT_EQ(dxfModel.lines[0].layer, "layer_3");
+        EXPECT_EQ(dxfModel.lines[0].color, 8);
+        EXPECT_EQ(dxfModel.lines[0].peURL, "tag_4");
+        EXPECT_EQ(dxfModel.arcs[99].radius, 93.965654951312871);
+        EXPECT_EQ(dxfModel.arcs[99].theta1, 5.3494183192069693);
+        EXPECT_EQ(dxfModel.polylines.bulges.back(), 0.022507378037480708);
+
+        // Every line end, polyline vertex and arc center or end is distinct
+        const auto jeoModel = convertToJeo(dxfModel);
+        EXPECT_EQ(jeoModel.points.size(), 200u * 2 + 100u * 3 + 50u * 5);
+        EXPECT_LE(jeoModel.colors.size(), 10u);
+        EXPECT_EQ(jeoModel.tags.size(), 5u);
+        expectEqual(convertToJeo(generateDxfModel(options)), jeoModel);
+
+        const auto outputPath = std::filesystem::temp_directory_path() / "dxf2jeo_generator_test.jeob";
+        generateFile(options, outputPath);
+        expectEqual(readJeo(outputPath), jeoModel);
+        std::filesystem::remove(outputPath);
+
+        options.seed             = 4;
+        options.sharedPointRatio = 0.9;
+        options.bulgeRatio       = 0.;
+        options.colorCount       = 0;
+        options.tagCount         = 0;
+        const auto otherDxfModel = generateDxfModel(options);
+        EXPECT_LT(convertToJeo(otherDxfModel).points.size(), jeoModel.points.size() / 2);
+        EXPECT_TRUE(otherDxfModel.polylines.bulges.empty());
+        for (std::uint64_t i = 0, n = otherDxfModel.polylines.size(); i < n; ++i)
+            EXPECT_FALSE(otherDxfModel.polylines[i].bulges);
+        for (const auto& line : otherDxfModel.lines) {
+            EXPECT_FALSE(line.color);
+            EXPECT_FALSE(line.peURL);
+        }
+
+        options.vertexCount = 1;
+        EXPECT_THROW(generateDxfModel(options), std::runtime_error);
+    }
+
+    TEST(dxf2jeotests, threadPoolRunsEveryTask)
+    {
+        auto threadPool = ThreadPool{4};
+        auto sum        = std::atomic<std::uint64_t>{0};
+        for (std::uint64_t i = 1; i <= 100; ++i) {
+            threadPool.submit([&, i]() {
+                // Tasks submitted from a worker land in its own deque, from which idle workers steal
+                for (std::uint64_t j = 0; j < i; ++j)
+                    threadPool.submit([&]() { ++sum; });
+            });
+        }
+        threadPool.wait();
+        EXPECT_EQ(sum, 5050);
+
+        threadPool.submit([]() { throw std::runtime_error{"task failure"}; });
+        EXPECT_THROW(threadPool.wait(), std::runtime_error);
+        threadPool.submit([&]() { ++sum; });
+        threadPool.wait();
+        EXPECT_EQ(sum, 5051);
+    }
+
+    TEST(dxf2jeotests, batchReportsFailuresPerFile)
+    {
+        const auto outputDir = std::filesystem::temp_directory_path() / "dxf2jeo_batch_test";
+        std::filesystem::remove_all(outputDir);
+
+        auto inputPaths = std::vector<std::filesystem::path>{getAssetDir()};
+        inputPaths.push_back(getAssetDir() / "missing.jeo");
+
+        const auto items = makeBatchItems(collectBatchInputs(inputPaths, {".jeo"}), outputDir, ".jeob");
+        ASSERT_EQ(items.size(), 3);
+        EXPECT_EQ(items[0].outputPath, outputDir / "test1.jeob");
+        EXPECT_EQ(items[1].outputPath, outputDir / "test2.jeob");
+        EXPECT_THROW(makeBatchItems({getAssetDir() / "test1.jeo", getAssetDir() / "test1.dxf"}, outputDir, ".jeob"), std::runtime_error);
+
+        std::filesystem::create_directories(outputDir);
+        const auto failures = runBatch(items, 3, [](const BatchItem& item) { writeJeo(readJeo(item.inputPath), item.outputPath); });
+        ASSERT_EQ(failures.size(), 1);
+        EXPECT_EQ(failures[0].inputPath, getAssetDir() / "missing.jeo");
+        expectEqual(readJeo(outputDir / "test1.jeob"), readJeo(getAssetDir() / "test1.jeo"));
+        expectEqual(readJeo(outputDir / "test2.jeob"), readJeo(getAssetDir() / "test2.jeo"));
+        std::filesystem::remove_all(outputDir);
+    }
+
+    TEST(dxf2jeotests, conversionCacheHitsOnIdenticalInput)
+    {
+        EXPECT_EQ(xxHash64(""), 0xef46db3751d8e999);
+        EXPECT_EQ(xxHash64("abc"), 0x44bc2cf5ad770999);
+        EXPECT_EQ(xxHash64("Nobody inspects the spammish repetition"), 0xfbcea83c8a378bf1);
+
+        const auto workDir   = std::filesystem::temp_directory_path() / "dxf2jeo_cache_test";
+        const auto inputPath = getAssetDir() / "test1.jeo";
+        std::filesystem::remove_all(workDir);
+        std::filesystem::create_directories(workDir);
+
+        auto       conversionCount = 0;
+        const auto convert         = [&](const std::filesystem::path& inputPath, const std::filesystem::path& outputPath) {
+            ++conversionCount;
+            writeJeo(readJeo(inputPath), outputPath);
+        };
+
+        auto cache = ConversionCache{workDir / "cache", 1 << 20, "test"};
+        EXPECT_FALSE(cache.convert(inputPath, workDir / "miss.jeo", convert));
+        EXPECT_TRUE(cache.convert(inputPath, workDir / "hit.jeo", convert));
+        EXPECT_FALSE(cache.convert(inputPath, workDir / "miss.jeob", convert));
+        std::filesystem::copy_file(inputPath, workDir / "copy.jeo");
+        EXPECT_TRUE(cache.convert(workDir / "copy.jeo", workDir / "copy_hit.jeo", convert));
+        EXPECT_EQ(conversionCount, 2);
+        expectEqual(readJeo(workDir / "hit.jeo"), readJeo(inputPath));
+        expectEqual(readJeo(workDir / "copy_hit.jeo"), readJeo(inputPath));
+
+        const auto stats = cache.stats();
+        EXPECT_EQ(stats.hits, 2u);
+        EXPECT_EQ(stats.misses, 2u);
+        EXPECT_EQ(stats.evictions, 0u);
+
+        auto otherContextCache = ConversionCache{workDir / "cache", 1 << 20, "other"};
+        EXPECT_FALSE(otherContextCache.convert(inputPath, workDir / "other.jeo", convert));
+
+        // Entries found on opening count towards the size, a cache fitting a single new entry evicting them
+        auto entryCache = ConversionCache{workDir / "cache", std::filesystem::file_size(workDir / "other.jeo"), "entry"};
+        EXPECT_FALSE(entryCache.convert(inputPath, workDir / "entry.jeo", convert));
+        EXPECT_GT(entryCache.stats().evictions, 0u);
+
+        auto tinyCache = ConversionCache{workDir / "tiny_cache", 1, "test"};
+        EXPECT_FALSE(tinyCache.convert(inputPath, workDir / "tiny.jeo", convert));
+        EXPECT_FALSE(tinyCache.convert(inputPath, workDir / "tiny.jeo", convert));
+        EXPECT_EQ(tinyCache.stats().evictions, 2u);
+        EXPECT_TRUE(std::filesystem::is_empty(workDir / "tiny_cache"));
+
+        std::filesystem::remove_all(workDir);
+    }
+
+    TEST(dxf2jeotests, conversionStatsMeasureStages)
+    {
+        EXPECT_EQ(measureStage(nullptr, "read", []() { return 42; }), 42);
+
+        auto stats = ConversionStats{};
+        EXPECT_EQ(measureStage(&stats, "read", []() { return 42; }), 42);
+        measureStage(&stats, "write", []() {
+            auto sum = 0.;
+            for (auto i = 0; i < 1'000'000; ++i)
+                sum += std::sqrt(static_cast<double>(i));
+            EXPECT_GT(sum, 0.);
+        });
+        setCount(stats, "points", 1);
+        setCount(stats, "points", 2);
+
+        ASSERT_EQ(stats.stages.size(), 2u);
+        EXPECT_EQ(stats.stages[0].name, "read");
+        EXPECT_EQ(stats.stages[1].name, "write");
+        EXPECT_GE(stats.stages[1].wallTime, 0.);
+        EXPECT_GE(stats.stages[1].cpuTime, 0.);
+        ASSERT_EQ(stats.counts.size(), 1u);
+        EXPECT_EQ(stats.counts[0].second, 2u);
+        EXPECT_GT(getPeakRss(), 0u);
+
+        EXPECT_NE(formatStatsText(stats).find("points"), std::string::npos);
+        EXPECT_NE(formatStatsJson(stats).find("\"points\""), std::string::npos);
+    }
+
+#if !defined(_WIN32)
+    TEST(dxf2jeotests, conversionServerConvertsPathsAndPayloads)
+    {
+        const auto workDir    = std::filesystem::temp_directory_path() / "dxf2jeo_server_test";
+        const auto socketPath = workDir / "server.sock";
+        std::filesystem::remove_all(workDir);
+        std::filesystem::create_directories(workDir);
+
+        auto server = std::thread{[&]() {
+            runConversionServer(socketPath, 2, [](const std::filesystem::path& inputPath, const std::filesystem::path& outputPath) {
+                writeJeo(readJeo(inputPath), outputPath);
+            });
+        }};
+        while (!std::filesystem::is_socket(socketPath))
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+
+        const auto expected = readJeo(getAssetDir() / "test1.jeo");
+        requestConversion(socketPath, getAssetDir() / "test1.jeo", workDir / "path.jeob");
+        expectEqual(readJeo(workDir / "path.jeob"), expected);
+        requestInlineConversion(socketPath, getAssetDir() / "test1.jeo", workDir / "inline.jeob");
+        expectEqual(readJeo(workDir / "inline.jeob"), expected);
+        EXPECT_THROW(requestConversion(socketPath, workDir / "missing.jeo", workDir / "missing.jeob"), std::runtime_error);
+
+        requestServerStop(socketPath);
+        server.join();
+        EXPECT_FALSE(std::filesystem::exists(socketPath));
+        std::filesystem::remove_all(workDir);
+    }
+#endif
 }
\ No newline at end of file